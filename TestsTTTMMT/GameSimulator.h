@@ -2,6 +2,7 @@
 #pragma once
 
 #include "BaseTypes.h"
+#include "PackedBoard.h"
 #include <vector>
 #include <random>
 #include <utility>
@@ -23,30 +24,14 @@
 
 namespace detail {
 
-    // Winning line descriptors: 3 indices per line encoded as {row,col} pairs
-    static constexpr std::pair<int8_t, int8_t> kLines[8][3] = {
-        /* rows    */ {{0,0},{0,1},{0,2}}, {{1,0},{1,1},{1,2}}, {{2,0},{2,1},{2,2}},
-        /* columns */ {{0,0},{1,0},{2,0}}, {{0,1},{1,1},{2,1}}, {{0,2},{1,2},{2,2}},
-        /* diagonals */ {{0,0},{1,1},{2,2}}, {{0,2},{1,1},{2,0}}
-    };
-
     inline bool isWinner(const Board& b, Square player)
     {
-        for (const auto& line : kLines) {
-            if (b.squares[line[0].first][line[0].second] == player &&
-                b.squares[line[1].first][line[1].second] == player &&
-                b.squares[line[2].first][line[2].second] == player)
-                return true;
-        }
-        return false;
+        return packedIsWinner(packBoard(b), player);
     }
 
     inline bool boardFull(const Board& b)
     {
-        for (int r = 0; r < 3; ++r)
-            for (int c = 0; c < 3; ++c)
-                if (b.squares[r][c] == Square::none) return false;
-        return true;
+        return packedMarks(packBoard(b)) == 9;
     }
 
     // Return list of empty squares as (row,col)
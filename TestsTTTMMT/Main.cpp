@@ -21,16 +21,131 @@ int main() {
 		} else {
 			std::cout << "Error: Round trip test was unsuccessful.\n\n\n";
 		}
+		if (frameRoundTripTest(boards)) {
+			std::cout << "Frame round trip test was successful.\n\n\n";
+		} else {
+			std::cout << "Error: Frame round trip test was unsuccessful.\n\n\n";
+		}
+		if (automaticCodecTest(boards, CompressionLevel::huffman)) {
+			std::cout << "Automatic codec test was successful.\n\n\n";
+		} else {
+			std::cout << "Error: Automatic codec test was unsuccessful.\n\n\n";
+		}
+		EncodeOptions symmetry;
+		symmetry.canonicalizeSymmetry = true;
+		if (frameRoundTripTest(boards, symmetry)) {
+			std::cout << "Symmetry frame round trip test was successful.\n\n\n";
+		} else {
+			std::cout << "Error: Symmetry frame round trip test was unsuccessful.\n\n\n";
+		}
+		EncodeOptions dedup;
+		dedup.deduplicateGames = true;
+		if (frameRoundTripTest(boards, dedup)) {
+			std::cout << "Deduplicated frame round trip test was successful.\n\n\n";
+		} else {
+			std::cout << "Error: Deduplicated frame round trip test was unsuccessful.\n\n\n";
+		}
+		dedup.canonicalizeSymmetry = true;
+		if (frameRoundTripTest(boards, dedup)) {
+			std::cout << "Deduplicated symmetry frame round trip test was successful.\n\n\n";
+		} else {
+			std::cout << "Error: Deduplicated symmetry frame round trip test was unsuccessful.\n\n\n";
+		}
+		if (decodeIntoTest(boards, dedup)) {
+			std::cout << "Decode into buffer test was successful.\n\n\n";
+		} else {
+			std::cout << "Error: Decode into buffer test was unsuccessful.\n\n\n";
+		}
+		if (deltaSyncTest(games)) {
+			std::cout << "Delta sync test was successful.\n\n\n";
+		} else {
+			std::cout << "Error: Delta sync test was unsuccessful.\n\n\n";
+		}
+		if (deltaSyncNetworkTest(games, 47'700)) {
+			std::cout << "Delta sync network test was successful.\n\n\n";
+		} else {
+			std::cout << "Error: Delta sync network test was unsuccessful.\n\n\n";
+		}
+		if (analyticsTest(games, symmetry)) {
+			std::cout << "Analytics test was successful.\n\n\n";
+		} else {
+			std::cout << "Error: Analytics test was unsuccessful.\n\n\n";
+		}
+		EncodeOptions raw;
+		raw.level = CompressionLevel::raw;
+		if (analyticsTest(games, raw)) {
+			std::cout << "Raw analytics test was successful.\n\n\n";
+		} else {
+			std::cout << "Error: Raw analytics test was unsuccessful.\n\n\n";
+		}
+		if (analyticsTest(games, dedup)) {
+			std::cout << "Deduplicated analytics test was successful.\n\n\n";
+		} else {
+			std::cout << "Error: Deduplicated analytics test was unsuccessful.\n\n\n";
+		}
 	}
 	
 	std::cout << "Random boards: " << gamesNum*10 << '\n';
 	std::cout << "Generating random boards...\n";
 	BoardStream randomBoards = createRandomBoards(gamesNum*10);
 	std::cout << "Completed.\n\n";
+	if (checksumTest(randomBoards)) {
+		std::cout << "Checksum test was successful.\n\n\n";
+	}
+	else {
+		std::cout << "Error: Checksum test was unsuccessful.\n\n\n";
+	}
+	if (frameHeaderTest(randomBoards)) {
+		std::cout << "Frame header test was successful.\n\n\n";
+	}
+	else {
+		std::cout << "Error: Frame header test was unsuccessful.\n\n\n";
+	}
+	if (packedBoardTest(randomBoards)) {
+		std::cout << "Packed board test was successful.\n\n\n";
+	}
+	else {
+		std::cout << "Error: Packed board test was unsuccessful.\n\n\n";
+	}
 	if (roundTripTest(randomBoards)) {
 		std::cout << "Round trip test was successful.\n\n\n";
 	}
 	else {
 		std::cout << "Error: Round trip test was unsuccessful.\n\n\n";
 	}
+	if (automaticCodecTest(randomBoards, CompressionLevel::raw)) {
+		std::cout << "Automatic codec test was successful.\n\n\n";
+	}
+	else {
+		std::cout << "Error: Automatic codec test was unsuccessful.\n\n\n";
+	}
+	for (CompressionLevel level : { CompressionLevel::raw, CompressionLevel::huffman, CompressionLevel::automatic }) {
+		EncodeOptions options;
+		options.level = level;
+		if (frameRoundTripTest(randomBoards, options)) {
+			std::cout << "Frame round trip test was successful.\n\n\n";
+		}
+		else {
+			std::cout << "Error: Frame round trip test was unsuccessful.\n\n\n";
+		}
+	}
+	const BoardStream migrated(randomBoards.begin(), randomBoards.begin() + 50'000);
+	if (concurrentMigrationTest(migrated, 200, 47'000)) {
+		std::cout << "Concurrent migration test was successful.\n\n\n";
+	}
+	else {
+		std::cout << "Error: Concurrent migration test was unsuccessful.\n\n\n";
+	}
+	if (fanOutTest(migrated, 47'500)) {
+		std::cout << "Fan-out test was successful.\n\n\n";
+	}
+	else {
+		std::cout << "Error: Fan-out test was unsuccessful.\n\n\n";
+	}
+	if (resumeTest(47'600)) {
+		std::cout << "Resume test was successful.\n\n\n";
+	}
+	else {
+		std::cout << "Error: Resume test was unsuccessful.\n\n\n";
+	}
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "UnitTests.h"
+#include <memory>
+#include <thread>
 
 BoardStream createRandomBoards(int numberOfBoards) {
 	BoardStream boards;
@@ -54,4 +56,518 @@ bool roundTripTest(const BoardStream& boards) {
 		}
 	}
 	return true;
+}
+
+bool frameRoundTripTest(const BoardStream& boards, const EncodeOptions& options) {
+	ByteVector frame = encodeBoards(boards, options);
+	std::cout << "Frame size: " << frame.size() << " Bytes.\n";
+
+	BoardStream recreatedBoards = decodeBoards(frame);
+	if (boards.size() != recreatedBoards.size()) return false;
+	return boards.empty() || memcmp(boards.data(), recreatedBoards.data(), boards.size() * sizeof(Board)) == 0;
+}
+
+bool automaticCodecTest(const BoardStream& boards, CompressionLevel expected) {
+	ByteVector frame = encodeBoards(boards);
+	std::cout << "Automatic codec: " << int(frame.empty() ? -1 : frame[0]) << ".\n";
+	if (frame.empty() || frame[0] != uint8_t(expected)) return false;
+	return decodeBoards(frame).size() == boards.size();
+}
+
+bool packedBoardTest(const BoardStream& boards) {
+	std::vector<PackedBoard> packed(boards.size());
+	std::vector<uint16_t> codes(boards.size());
+	std::vector<uint8_t> marks(boards.size());
+	std::vector<uint8_t> winners(boards.size());
+	packBoards(boards.data(), boards.size(), packed.data());
+	packedToFifteenBits(packed.data(), packed.size(), codes.data());
+	countMarks(packed.data(), packed.size(), marks.data());
+	detectWinners(packed.data(), packed.size(), winners.data());
+
+	for (size_t i = 0; i < boards.size(); i++) {
+		const Board& board = boards[i];
+		Board unpacked = unpackBoard(packed[i]);
+		if (memcmp(&board, &unpacked, sizeof(Board)) != 0) return false;
+
+		uint16_t code = rowToFiveBit(board.squares[0]) | rowToFiveBit(board.squares[1]) << 5 | rowToFiveBit(board.squares[2]) << 10;
+		if (codes[i] != code) return false;
+		Board decoded = unpackBoard(fifteenBitToPacked(code));
+		if (memcmp(&board, &decoded, sizeof(Board)) != 0) return false;
+
+		int count = 0;
+		uint8_t lines[2] = { 0, 0 };
+		for (int p = 0; p < 2; p++) {
+			Square player = p == 0 ? Square::X : Square::O;
+			for (int k = 0; k < 3; k++) {
+				bool row = true, column = true;
+				for (int j = 0; j < 3; j++) {
+					row &= board.squares[k][j] == player;
+					column &= board.squares[j][k] == player;
+				}
+				lines[p] |= row | column;
+			}
+			bool diagonal = true, antiDiagonal = true;
+			for (int j = 0; j < 3; j++) {
+				diagonal &= board.squares[j][j] == player;
+				antiDiagonal &= board.squares[j][2 - j] == player;
+			}
+			lines[p] |= diagonal | antiDiagonal;
+		}
+		for (int y = 0; y < 3; y++) {
+			for (int x = 0; x < 3; x++) {
+				count += board.squares[y][x] != Square::none;
+			}
+		}
+		if (marks[i] != count) return false;
+		if (winners[i] != (lines[0] * detail::X_WINS | lines[1] * detail::O_WINS)) return false;
+	}
+	return true;
+}
+
+bool checksumTest(const BoardStream& boards) {
+	const char* check = "123456789";
+	if (crc32c(reinterpret_cast<const uint8_t*>(check), 9) != 0xE3069283) return false;
+
+	ByteVector frame = encodeBoards(boards);
+	if (decodeBoards(frame).size() != boards.size()) return false;
+
+	// A flipped bit anywhere in front of the checksum section must be caught
+	for (size_t pos : { size_t(40), frame.size() / 2, frame.size() * 3 / 4 }) {
+		ByteVector corrupted = frame;
+		corrupted[pos] ^= 0b100;
+		if (!decodeBoards(corrupted).empty()) return false;
+	}
+	return true;
+}
+
+bool frameHeaderTest(const BoardStream& boards) {
+	EncodeOptions options;
+	options.checksums = false;
+	const ByteVector frame = encodeBoards(boards, options);
+	if (decodeBoards(frame).size() != boards.size()) return false;
+
+	auto patched = [&](size_t offset, uint64_t value) {
+		ByteVector corrupted = frame;
+		for (int i = 0; i < 8; i++) corrupted[offset + i] = uint8_t(value >> 8 * i);
+		return corrupted;
+	};
+	// Foreign magic or version, section sizes that wrap around, more boards than the frame can hold
+	const uint64_t format = frame[0] | uint64_t(frame[1]) << 8;
+	for (const ByteVector& corrupted : { patched(0, format), patched(0, format | uint64_t(0xFFFF) << 16 | uint64_t(detail::FRAME_MAGIC) << 32),
+		patched(8, UINT64_MAX - detail::HEADER_BYTES + 1), patched(24, UINT64_MAX), patched(40, uint64_t(1) << 60) }) {
+		if (!decodeBoards(corrupted).empty() || decodedBoardCount(corrupted) != 0) return false;
+	}
+
+	// A stream too dense to pass without checksums gets them anyway
+	const BoardStream same(1 << 20, boards.front());
+	options.level = CompressionLevel::huffman;
+	const BoardStream decoded = decodeBoards(encodeBoards(same, options));
+	return decoded.size() == same.size() && memcmp(decoded.data(), same.data(), same.size() * sizeof(Board)) == 0;
+}
+
+bool decodeIntoTest(const BoardStream& boards, const EncodeOptions& options) {
+	ByteVector frame = encodeBoards(boards, options);
+	const size_t count = decodedBoardCount(frame);
+	if (count != boards.size()) return false;
+
+	// The same storage and workspace serve every pass
+	BoardStream storage(count);
+	DecodeWorkspace workspace;
+	for (int pass = 0; pass < 2; pass++) {
+		std::fill(storage.begin(), storage.end(), Board{});
+		if (decodeBoardsInto(frame, storage, workspace) != count) return false;
+		if (count > 0 && memcmp(boards.data(), storage.data(), count * sizeof(Board)) != 0) return false;
+	}
+	return count == 0 || decodeBoardsInto(frame, std::span<Board>(storage).first(count - 1), workspace) == 0;
+}
+
+static bool sameGames(const GameList& a, const GameList& b) {
+	if (a.size() != b.size()) return false;
+	for (size_t i = 0; i < a.size(); i++) {
+		if (a[i].boards.size() != b[i].boards.size()) return false;
+		if (!a[i].boards.empty() && memcmp(a[i].boards.data(), b[i].boards.data(), a[i].boards.size() * sizeof(Board)) != 0) return false;
+	}
+	return true;
+}
+
+// The receiver is missing a stretch of games, holds some the sender dropped and has a few changed
+static GameList staleCopy(const GameList& games) {
+	GameList stale(games.begin(), games.begin() + games.size() / 2);
+	stale.insert(stale.end(), games.begin() + games.size() / 2 + 500, games.end());
+	stale.insert(stale.begin() + stale.size() / 3, games.begin(), games.begin() + 300);
+	for (size_t i = 0; i < stale.size(); i += stale.size() / 10) {
+		std::swap(stale[i].boards.front(), stale[i].boards.back());
+	}
+	return stale;
+}
+
+bool deltaSyncTest(const GameList& games) {
+	GameList stale = staleCopy(games);
+
+	const ByteVector fingerprints = serializeFingerprints(splitIntoBlocks(stale));
+	const ByteVector delta = encodeDelta(games, deserializeFingerprints(fingerprints));
+	std::cout << "Fingerprints: " << fingerprints.size() << " Bytes, delta: " << delta.size() << " Bytes, full frame: "
+		<< encodeBoards(extractBoardsFromGames(games)).size() << " Bytes.\n";
+	if (!applyDelta(stale, delta) || !sameGames(stale, games)) return false;
+
+	// A count that does not match the size is rejected, even one whose byte size overflows
+	ByteVector bogus(16);
+	putU64(bogus.data(), (uint64_t(1) << 61) + 1);
+	if (!deserializeFingerprints(bogus).empty() || !deserializeFingerprints(ByteVector(12)).empty()) return false;
+
+	// Nothing to send when both sides already agree, and an empty receiver gets everything
+	GameList empty;
+	const ByteVector full = encodeDelta(games, {});
+	if (!applyDelta(stale, encodeDelta(games, deserializeFingerprints(serializeFingerprints(splitIntoBlocks(stale)))))
+		|| !sameGames(stale, games) || !applyDelta(empty, full) || !sameGames(empty, games)) return false;
+
+	// Games are cut by their stored lengths, not by their boards: an empty game, one with an
+	// empty board and two games joined into one survive as they are
+	GameList odd(games.begin(), games.begin() + 100);
+	odd[10].boards.clear();
+	odd[20].boards.insert(odd[20].boards.begin() + 1, Board{});
+	odd[30].boards.insert(odd[30].boards.end(), odd[31].boards.begin(), odd[31].boards.end());
+	GameList oddCopy;
+	return applyDelta(oddCopy, encodeDelta(odd, {})) && sameGames(oddCopy, odd) && !applyDelta(oddCopy, ByteVector(full.begin(), full.begin() + 40));
+}
+
+bool analyticsTest(const GameList& games, EncodeOptions options) {
+	options.blockSummaries = true;
+	const BoardStream boards = extractBoardsFromGames(games);
+	const ByteVector frame = encodeBoards(boards, options);
+	std::cout << "Frame size with summaries: " << frame.size() << " Bytes.\n";
+
+	StreamSummary expected;
+	expected.boards = boards.size();
+	expected.games = games.size();
+	for (const Game& game : games) {
+		expected.gameLengths[std::min<size_t>(game.boards.size(), 9) - 1]++;
+		const PackedBoard last = packBoard(game.boards.back());
+		if (packedIsWinner(last, Square::X)) expected.xWins++;
+		else if (packedIsWinner(last, Square::O)) expected.oWins++;
+	}
+	const std::optional<StreamSummary> summary = summarizeFrame(frame);
+	if (!summary || summary->boards != expected.boards || summary->games != expected.games) return false;
+	if (summary->xWins != expected.xWins || summary->oWins != expected.oWins || summary->gameLengths != expected.gameLengths) return false;
+
+	// Positions that occur often, rarely and not at all
+	for (const Board& board : { boards.front(), boards[boards.size() / 2], boards.back(), Board{} }) {
+		uint64_t count = 0;
+		for (const Board& other : boards) count += memcmp(&board, &other, sizeof(Board)) == 0;
+		if (countPosition(frame, board) != count) return false;
+	}
+
+	// Only the blocks holding the rarest board
+	std::vector<size_t> freq(HuffmanTree::SYMBOL_COUNT, 0);
+	for (const Board& board : boards) ++freq[boardToFifteenBit(board)];
+	size_t rarest = 0;
+	for (size_t i = 1; i < boards.size(); i++) {
+		if (freq[boardToFifteenBit(boards[i])] < freq[boardToFifteenBit(boards[rarest])]) rarest = i;
+	}
+	const Board& target = boards[rarest];
+	BoardStream expectedBoards;
+	for (const BlockSummary& block : readBlockSummaries(frame)) {
+		if (!block.contains(target)) continue;
+		expectedBoards.insert(expectedBoards.end(), boards.begin() + block.firstBoard, boards.begin() + block.firstBoard + block.boards);
+	}
+	const std::optional<BoardStream> selected = selectBoards(frame, [&](const BlockSummary& block) { return block.contains(target); });
+	if (!selected) return false;
+	std::cout << "Selected " << selected->size() << " of " << boards.size() << " boards.\n";
+	if (selected->empty() || selected->size() != expectedBoards.size()
+		|| memcmp(selected->data(), expectedBoards.data(), selected->size() * sizeof(Board)) != 0) return false;
+
+	// Empty answers from intact frames are values, not failures
+	const ByteVector emptyFrame = encodeBoards({}, options);
+	const std::optional<BoardStream> none = selectBoards(frame, [](const BlockSummary&) { return false; });
+	if (!none || !none->empty() || countPosition(emptyFrame, target) != uint64_t(0)) return false;
+	if (!summarizeFrame(emptyFrame) || summarizeFrame(emptyFrame)->boards != 0) return false;
+	const ByteVector truncated(frame.begin(), frame.begin() + frame.size() / 2);
+	if (countPosition(truncated, target) || selectBoards(truncated, [](const BlockSummary&) { return true; }) || summarizeFrame(truncated)) return false;
+
+	// A long run of one game leaves blocks holding few of the stream's positions, which list them instead
+	BoardStream repeated = boards;
+	for (int i = 0; i < 5000; i++) repeated.insert(repeated.end(), games.front().boards.begin(), games.front().boards.end());
+	const ByteVector repeatedFrame = encodeBoards(repeated, options);
+	const Board& last = games.front().boards.back();
+	uint64_t lastCount = 0;
+	for (const Board& other : repeated) lastCount += memcmp(&last, &other, sizeof(Board)) == 0;
+	const std::optional<StreamSummary> repeatedSummary = summarizeFrame(repeatedFrame);
+	if (countPosition(repeatedFrame, last) != lastCount || !repeatedSummary || repeatedSummary->boards != repeated.size()) return false;
+
+	// A damaged summary section is refused, not trusted
+	uint64_t summaryBytes = 0;
+	uint64_t checksumBytes = 0;
+	for (int i = 0; i < 8; i++) {
+		checksumBytes |= uint64_t(frame[56 + i]) << 8 * i;
+		summaryBytes |= uint64_t(frame[64 + i]) << 8 * i;
+	}
+	if (checksumBytes == 0) return true;
+	ByteVector corrupted = frame;
+	corrupted[frame.size() - checksumBytes - summaryBytes + 8] ^= 1;
+	return readBlockSummaries(corrupted).empty() && !countPosition(corrupted, target) && !summarizeFrame(corrupted)
+		&& !selectBoards(corrupted, [](const BlockSummary&) { return true; });
+}
+
+bool concurrentMigrationTest(const BoardStream& boards, int migrations, uint32_t firstPort) {
+	// Every transfer shares one io thread, encoding and decoding run on the workers
+	asio::io_context io;
+	asio::thread_pool workers(2);
+	int received = 0;
+	int sent = 0;
+	for (int i = 0; i < migrations; i++) {
+		asio::co_spawn(io, [&, i]() -> asio::awaitable<void> {
+			const BoardStream decoded = co_await asyncStreamInBoards("127.0.0.1", firstPort + i, workers);
+			received += decoded.size() == boards.size() && memcmp(decoded.data(), boards.data(), boards.size() * sizeof(Board)) == 0;
+		}, asio::detached);
+	}
+	for (int i = 0; i < migrations; i++) {
+		asio::co_spawn(io, [&, i]() -> asio::awaitable<void> {
+			sent += co_await asyncStreamOutBoards(boards, "127.0.0.1", firstPort + i, workers);
+		}, asio::detached);
+	}
+	io.run();
+	return received == migrations && sent == migrations;
+}
+
+bool fanOutTest(const BoardStream& boards, uint32_t firstPort) {
+	// Three receivers and one port nobody listens on
+	const int receivers = 3;
+	std::vector<Endpoint> destinations;
+	for (int i = 0; i <= receivers; i++) destinations.push_back({ "127.0.0.1", firstPort + i });
+
+	asio::io_context io;
+	asio::thread_pool workers(2);
+	int received = 0;
+	for (int i = 0; i < receivers; i++) {
+		asio::co_spawn(io, [&, i]() -> asio::awaitable<void> {
+			const BoardStream decoded = co_await asyncStreamInBoards("127.0.0.1", firstPort + i, workers);
+			received += decoded.size() == boards.size() && memcmp(decoded.data(), boards.data(), boards.size() * sizeof(Board)) == 0;
+		}, asio::detached);
+	}
+	std::vector<TransferStatus> statuses;
+	std::vector<TransferStatus> lastReported(destinations.size());
+	asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+		statuses = co_await asyncStreamOutBoardsToAll(boards, destinations, workers, {},
+			[&](size_t destination, const TransferStatus& status) { lastReported[destination] = status; });
+	}, asio::detached);
+	io.run();
+
+	if (received != receivers || statuses.size() != destinations.size()) return false;
+	for (size_t i = 0; i < destinations.size(); i++) {
+		const bool reachable = i < size_t(receivers);
+		if (statuses[i].delivered != reachable || lastReported[i].delivered != reachable) return false;
+		if (reachable && statuses[i].ackedBytes != statuses[i].totalBytes) return false;
+		if (!reachable && (statuses[i].attempts != detail::MAX_ATTEMPTS || statuses[i].lastError.empty())) return false;
+	}
+	return true;
+}
+
+// What one connection through the proxy carried
+struct ProxyLeg {
+	uint64_t resumeChunk = 0;   // receiver's answer to the handshake
+	uint64_t payloadBytes = 0;  // sender bytes after the handshake
+	uint64_t replyBytes = 0;    // every byte the receiver sent back
+};
+
+struct ProxyLink {
+	asio::ip::tcp::socket client;
+	asio::ip::tcp::socket server;
+	ProxyLeg& leg;
+
+	void close() {
+		asio::error_code ignored;
+		this->client.close(ignored);
+		this->server.close(ignored);
+	}
+};
+
+constexpr uint64_t PROXY_HANDSHAKE_BYTES = 24;
+
+// Sender to receiver. The first connection is cut after `cutBytes` payload bytes (0: never)
+// or, with `corrupt`, gets payload byte 1000 flipped.
+static asio::awaitable<void> pumpToServer(std::shared_ptr<ProxyLink> link, bool first, uint64_t cutBytes, bool corrupt) {
+	uint8_t buffer[1 << 14];
+	uint64_t forwarded = 0;
+	try {
+		for (;;) {
+			size_t size = co_await link->client.async_read_some(asio::buffer(buffer), asio::use_awaitable);
+			const uint64_t limit = PROXY_HANDSHAKE_BYTES + cutBytes;
+			const bool cut = first && cutBytes > 0 && forwarded + size >= limit;
+			if (cut) size = size_t(limit - forwarded);
+			const uint64_t flip = PROXY_HANDSHAKE_BYTES + 1000;
+			if (first && corrupt && forwarded <= flip && flip < forwarded + size) buffer[flip - forwarded] ^= 1;
+			co_await asio::async_write(link->server, asio::buffer(buffer, size), asio::use_awaitable);
+			forwarded += size;
+			link->leg.payloadBytes = forwarded > PROXY_HANDSHAKE_BYTES ? forwarded - PROXY_HANDSHAKE_BYTES : 0;
+			if (cut) break;
+		}
+	}
+	catch (std::exception&) {
+	}
+	link->close();
+}
+
+// Receiver to sender, noting the resume chunk of the handshake. The first connection is cut
+// after `cutBytes` bytes (0: never).
+static asio::awaitable<void> pumpToClient(std::shared_ptr<ProxyLink> link, bool first, uint64_t cutBytes) {
+	uint8_t buffer[1 << 14];
+	try {
+		co_await asio::async_read(link->server, asio::buffer(buffer, 8), asio::use_awaitable);
+		for (int i = 0; i < 8; i++) link->leg.resumeChunk = link->leg.resumeChunk << 8 | buffer[i];
+		co_await asio::async_write(link->client, asio::buffer(buffer, 8), asio::use_awaitable);
+		link->leg.replyBytes = 8;
+		for (;;) {
+			size_t size = co_await link->server.async_read_some(asio::buffer(buffer), asio::use_awaitable);
+			const bool cut = first && cutBytes > 0 && link->leg.replyBytes + size >= cutBytes;
+			if (cut) size = size_t(cutBytes - link->leg.replyBytes);
+			co_await asio::async_write(link->client, asio::buffer(buffer, size), asio::use_awaitable);
+			link->leg.replyBytes += size;
+			if (cut) break;
+		}
+	}
+	catch (std::exception&) {
+	}
+	link->close();
+}
+
+// Connects to a local port, retrying while its listener may still be starting up
+static asio::awaitable<bool> connectLocal(asio::ip::tcp::socket& socket, uint32_t port) {
+	using asio::ip::tcp;
+
+	for (int attempt = 0;; attempt++) {
+		asio::error_code ec;
+		co_await socket.async_connect(tcp::endpoint(asio::ip::make_address("127.0.0.1"), port), asio::redirect_error(asio::use_awaitable, ec));
+		if (!ec) co_return true;
+		if (attempt == 50) co_return false;
+		socket.close(ec);
+		asio::steady_timer wait(socket.get_executor(), std::chrono::milliseconds(20));
+		co_await wait.async_wait(asio::use_awaitable);
+	}
+}
+
+// Forwards legs.size() connections on `port` to `target`. `cutReplyBytes` cuts the first
+// connection on its way back instead, see pumpToClient.
+static asio::awaitable<void> runProxy(uint32_t port, uint32_t target, std::vector<ProxyLeg>& legs, uint64_t cutBytes, bool corrupt,
+	uint64_t cutReplyBytes = 0) {
+	using asio::ip::tcp;
+
+	auto executor = co_await asio::this_coro::executor;
+	tcp::acceptor acceptor(executor, tcp::endpoint(tcp::v4(), port));
+	for (size_t i = 0; i < legs.size(); i++) {
+		tcp::socket client = co_await acceptor.async_accept(asio::use_awaitable);
+		std::shared_ptr<ProxyLink> link(new ProxyLink{ std::move(client), tcp::socket(executor), legs[i] });
+		if (!(co_await connectLocal(link->server, target))) co_return;
+		asio::co_spawn(executor, pumpToServer(link, i == 0, cutBytes, corrupt), asio::detached);
+		asio::co_spawn(executor, pumpToClient(link, i == 0, cutReplyBytes), asio::detached);
+	}
+}
+
+bool resumeTest(uint32_t firstPort) {
+	using namespace detail;
+
+	ByteVector payload(76 * CHUNK_BYTES + 1234);
+	for (size_t i = 0; i < payload.size(); i++) payload[i] = uint8_t(i * 131 + (i >> 11));
+
+	// The link drops after 30 of 77 chunks: the second connection only carries the chunks the receiver lacks
+	{
+		asio::io_context io;
+		std::vector<ProxyLeg> legs(2);
+		ByteVector received;
+		TransferStatus status;
+		asio::co_spawn(io, [&]() -> asio::awaitable<void> { received = co_await asyncGetData("127.0.0.1", firstPort + 1); }, asio::detached);
+		asio::co_spawn(io, runProxy(firstPort, firstPort + 1, legs, 30 * CHUNK_BYTES, false), asio::detached);
+		asio::co_spawn(io, asyncSendData("127.0.0.1", firstPort, payload, status), asio::detached);
+		io.run();
+
+		std::cout << "Resumed at chunk " << legs[1].resumeChunk << " after " << status.attempts << " attempts.\n";
+		if (received != payload || !status.delivered || status.attempts != 2) return false;
+		if (legs[1].resumeChunk == 0 || legs[1].resumeChunk > 30) return false;
+		if (legs[1].payloadBytes != payload.size() - legs[1].resumeChunk * CHUNK_BYTES) return false;
+	}
+
+	// A flipped byte fails the content hash: the receiver drops its state and everything is sent again
+	{
+		asio::io_context io;
+		std::vector<ProxyLeg> legs(2);
+		asio::co_spawn(io, runProxy(firstPort + 2, firstPort + 3, legs, 0, true), asio::detached);
+		std::thread proxy([&] { io.run(); });
+		ByteVector received;
+		std::thread receiver([&] { received = getData("127.0.0.1", firstPort + 3); });
+		const bool sent = sendData("127.0.0.1", firstPort + 2, payload);
+		receiver.join();
+		proxy.join();
+		if (!sent || received != payload) return false;
+		if (legs[0].payloadBytes != payload.size() || legs[1].resumeChunk != 0 || legs[1].payloadBytes != payload.size()) return false;
+	}
+
+	// Stray connections do not use up the receiver's attempts, and a chunk size that would overflow
+	// the chunk count is refused instead of passing for an empty, intact stream
+	{
+		asio::io_context io;
+		ByteVector received;
+		bool sent = false;
+		asio::co_spawn(io, [&]() -> asio::awaitable<void> { received = co_await asyncGetData("127.0.0.1", firstPort + 4); }, asio::detached);
+		asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+			using asio::ip::tcp;
+			auto executor = co_await asio::this_coro::executor;
+			for (int i = 0; i <= MAX_ATTEMPTS; i++) {
+				tcp::socket stray(executor);
+				if (!(co_await connectLocal(stray, firstPort + 4))) co_return;
+			}
+			tcp::socket socket(executor);
+			if (!(co_await connectLocal(socket, firstPort + 4))) co_return;
+			uint8_t handshake[24];
+			for (int i = 0; i < 8; i++) {
+				handshake[i] = uint8_t(CONTENT_HASH_SEED >> 8 * (7 - i));
+				handshake[8 + i] = uint8_t(uint64_t(100) >> 8 * (7 - i));
+				handshake[16 + i] = 0xFF;
+			}
+			co_await asio::async_write(socket, asio::buffer(handshake), asio::use_awaitable);
+			uint8_t answer[8];
+			asio::error_code closed;
+			co_await asio::async_read(socket, asio::buffer(answer), asio::redirect_error(asio::use_awaitable, closed));
+			if (!closed) co_return;
+			sent = co_await asyncSendData("127.0.0.1", firstPort + 4, payload);
+		}, asio::detached);
+		io.run();
+		if (!sent || received != payload) return false;
+	}
+	return true;
+}
+
+bool deltaSyncNetworkTest(const GameList& games, uint32_t firstPort) {
+	using namespace detail;
+
+	// A stale receiver catches up over one requestData/serveData exchange
+	{
+		GameList stale = staleCopy(games);
+		bool sent = false;
+		std::thread sender([&] { sent = syncOutGames(games, "127.0.0.1", firstPort); });
+		const bool synced = syncInGames(stale, "127.0.0.1", firstPort);
+		sender.join();
+		if (!sent || !synced || !sameGames(stale, games)) return false;
+	}
+
+	// The reply is cut after a few chunks: the client repeats the request, which the server
+	// still holds, and is sent the rest of the reply it already prepared
+	{
+		const uint64_t replySize = encodeDelta(games, {}).size();
+		if (replySize <= 4 * CHUNK_BYTES) return false;
+		asio::io_context io;
+		std::vector<ProxyLeg> legs(2);
+		asio::co_spawn(io, runProxy(firstPort + 1, firstPort + 2, legs, 0, false, 4 * CHUNK_BYTES), asio::detached);
+		std::thread proxy([&] { io.run(); });
+		bool sent = false;
+		std::thread sender([&] { sent = syncOutGames(games, "127.0.0.1", firstPort + 2); });
+		GameList empty;
+		const bool synced = syncInGames(empty, "127.0.0.1", firstPort + 1);
+		sender.join();
+		proxy.join();
+
+		std::cout << "Reply resumed after " << legs[0].replyBytes << " of " << replySize << " Bytes.\n";
+		if (!sent || !synced || !sameGames(empty, games)) return false;
+		// The repeated request is already held whole and the second leg carries less than a full reply
+		if (legs[0].replyBytes != 4 * CHUNK_BYTES || legs[1].resumeChunk == 0 || legs[1].replyBytes >= replySize) return false;
+	}
+	return true;
 }
\ No newline at end of file
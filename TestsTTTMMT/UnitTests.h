@@ -3,7 +3,21 @@
 #include "BaseTypes.h"
 #include "BoardConverter.h"
 #include "HuffmanTree.h"
+#include "TicTacToeMassMigrationTool.h"
+#include "DeltaSync.h"
 
 BoardStream createRandomBoards(int numberOfBoards);
 
-bool roundTripTest(const BoardStream& boards);
\ No newline at end of file
+bool roundTripTest(const BoardStream& boards);
+bool frameRoundTripTest(const BoardStream& boards, const EncodeOptions& options = {});
+bool automaticCodecTest(const BoardStream& boards, CompressionLevel expected);
+bool packedBoardTest(const BoardStream& boards);
+bool checksumTest(const BoardStream& boards);
+bool frameHeaderTest(const BoardStream& boards);
+bool decodeIntoTest(const BoardStream& boards, const EncodeOptions& options = {});
+bool deltaSyncTest(const GameList& games);
+bool deltaSyncNetworkTest(const GameList& games, uint32_t firstPort);
+bool analyticsTest(const GameList& games, EncodeOptions options = {});
+bool concurrentMigrationTest(const BoardStream& boards, int migrations, uint32_t firstPort);
+bool fanOutTest(const BoardStream& boards, uint32_t firstPort);
+bool resumeTest(uint32_t firstPort);
\ No newline at end of file
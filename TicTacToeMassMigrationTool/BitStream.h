@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+
+#include "BaseTypes.h"
+
+/* ---------------------------------------------------------------------------
+ *  BitWriter
+ *
+ *  Appends bit fields to the end of a ByteVector using the same LSB-first
+ *  layout as boardsToMemoryBlock(): bit 0 of the first field lands in bit 0
+ *  of the first appended byte and fields follow each other without padding.
+ *
+ *  write(bits, count)
+ *      Appends the low `count` bits of `bits` (count <= 64). Bits above
+ *      `count` must be zero.
+ *
+ *  flush()
+ *      Appends the last partial byte, zero padded. Must be called once after
+ *      the final write().
+ *
+ *  BitReader reads the same layout back. Reading past the end yields zeros.
+ *  peek(count) returns the next `count` bits (count <= 56) without consuming
+ *  them, skip(count) consumes them and position() is the number of bits
+ *  consumed so far.
+ * ------------------------------------------------------------------------- */
+
+class BitWriter {
+	ByteVector& data;
+	uint64_t scratch = 0;
+	uint8_t scratchBits = 0;
+public:
+	explicit BitWriter(ByteVector& data) : data(data) {}
+
+	void write(uint64_t bits, uint8_t count) {
+		if (count > 56) {
+			write(bits & 0xFFFF'FFFF, 32);
+			write(bits >> 32, count - 32);
+			return;
+		}
+		scratch |= bits << scratchBits;
+		scratchBits += count;
+		while (scratchBits >= 8) {
+			data.push_back(uint8_t(scratch));
+			scratch >>= 8;
+			scratchBits -= 8;
+		}
+	}
+
+	void flush() {
+		if (scratchBits > 0) data.push_back(uint8_t(scratch));
+		scratch = 0;
+		scratchBits = 0;
+	}
+};
+
+class BitReader {
+	const uint8_t* data;
+	size_t bytes;
+	size_t bitPos = 0;
+public:
+	BitReader(const uint8_t* data, size_t bytes) : data(data), bytes(bytes) {}
+
+	uint64_t peek(uint8_t count) const {
+		const size_t byteIdx = bitPos >> 3;
+		uint64_t scratch = 0;
+		for (size_t i = 0; i < 8 && byteIdx + i < bytes; i++) {
+			scratch |= uint64_t(data[byteIdx + i]) << 8 * i;
+		}
+		scratch >>= bitPos & 0b111;
+		return scratch & ((uint64_t(1) << count) - 1);
+	}
+
+	void skip(size_t count) { bitPos += count; }
+	size_t position() const { return bitPos; }
+
+	uint64_t read(uint8_t count) {
+		if (count > 56) {
+			uint64_t low = read(32);
+			return low | read(count - 32) << 32;
+		}
+		uint64_t bits = peek(count);
+		bitPos += count;
+		return bits;
+	}
+};
+
+/* ---------------------------------------------------------------------------
+ *  Byte and bit helpers shared by the frame, dictionary and delta formats
+ *
+ *  putU64/getU64 and putU32/getU32 store integers little-endian, appendU32
+ *  adds one to the end of a ByteVector. bitWidth(values) is the number of
+ *  bits needed for the ids 0 .. values - 1 and mix64 is the splitmix64
+ *  finalizer, which spreads every input bit over the low bits of a hash.
+ * ------------------------------------------------------------------------- */
+
+inline void putU64(uint8_t* out, uint64_t value) {
+	for (int i = 0; i < 8; i++) out[i] = uint8_t(value >> 8 * i);
+}
+
+inline uint64_t getU64(const uint8_t* in) {
+	uint64_t value = 0;
+	for (int i = 0; i < 8; i++) value |= uint64_t(in[i]) << 8 * i;
+	return value;
+}
+
+inline void putU32(uint8_t* out, uint32_t value) {
+	for (int i = 0; i < 4; i++) out[i] = uint8_t(value >> 8 * i);
+}
+
+inline void appendU32(ByteVector& out, uint32_t value) {
+	for (int i = 0; i < 4; i++) out.push_back(uint8_t(value >> 8 * i));
+}
+
+inline uint32_t getU32(const uint8_t* in) {
+	uint32_t value = 0;
+	for (int i = 0; i < 4; i++) value |= uint32_t(in[i]) << 8 * i;
+	return value;
+}
+
+inline uint8_t bitWidth(size_t values) {
+	uint8_t width = 0;
+	while ((size_t(1) << width) < values) width++;
+	return width;
+}
+
+inline uint64_t mix64(uint64_t hash) {
+	hash ^= hash >> 30;
+	hash *= 0xbf58'476d'1ce4'e5b9;
+	hash ^= hash >> 27;
+	hash *= 0x94d0'49bb'1331'11eb;
+	hash ^= hash >> 31;
+	return hash;
+}
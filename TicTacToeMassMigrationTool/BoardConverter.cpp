@@ -174,7 +174,8 @@ void fiveBitsToRow(uint8_t bits, Square(&row)[3]) {
  *      -> rowBits  = (scratch >> bitIdx) & 0b1'1111  // take 5 bits
  *      -> Decode via fiveBitsToRow(rowBits, board.squares[r]).
  *      -> bitPos  += 5.
- *    Boards are pushed to the result in order.
+ *    Boards are written in order, either to a new BoardStream or to caller
+ *    storage of at least boardCount boards.
  *
  *  Endianness
  *  ----------
@@ -189,11 +190,41 @@ void fiveBitsToRow(uint8_t bits, Square(&row)[3]) {
  *    -> Unused high bits of the last byte (if totalBits % 8 != 0) are zero in
  *      boardsToMemoryBlocks output.
  *
+ *  Single boards
+ *  -------------
+ *    boardToFifteenBit / fifteenBitToBoard convert one board to and from the
+ *    15-bit value that occupies its slot in the stream (row 0 in bits 0-4).
+ *    This is the symbol the Huffman stage works on. Both go through the
+ *    table driven PackedBoard conversions, which are built from the row
+ *    functions above.
+ *
+ *  Games in a stream
+ *  -----------------
+ *    A BoardStream is a concatenation of games. startsGame() is true for the
+ *    first board of a game, i.e. a board with at most one mark. Stream
+ *    transforms that work per game (see BoardSymmetry.h) split on it.
+ *
  *  Complexity
  *  ----------
  *    O(N) time where N = number of boards; contiguous O(totalBytes) storage.
  * --------------------------------------------------------------------------- */
 
+uint16_t boardToFifteenBit(const Board& board) {
+	return packedToFifteenBit(packBoard(board));
+}
+
+Board fifteenBitToBoard(uint16_t bits) {
+	return unpackBoard(fifteenBitToPacked(bits));
+}
+
+uint8_t countMarks(const Board& board) {
+	return packedMarks(packBoard(board));
+}
+
+bool startsGame(const Board& board) {
+	return countMarks(board) <= 1;
+}
+
 ByteVector boardsToMemoryBlock(const BoardStream& boards) {
 	const size_t totalBits = boards.size() * 15;
 	const size_t totalBytes = (totalBits + 7) >> 3;   // ceil(bits/8)
@@ -221,13 +252,16 @@ ByteVector boardsToMemoryBlock(const BoardStream& boards) {
 }
 
 BoardStream memoryBlockToBoards(const std::uint8_t* data, size_t byteCount, size_t boardCount) {
-	BoardStream boards;
-	boards.reserve(boardCount);
+	BoardStream boards(boardCount);
+	memoryBlockToBoards(data, byteCount, boards.data(), boardCount);
+	return boards;
+}
 
+void memoryBlockToBoards(const std::uint8_t* data, size_t byteCount, Board* boards, size_t boardCount) {
 	size_t bitPos = 0;
 	for (size_t b = 0; b < boardCount; ++b)
 	{
-		Board board{};
+		Board& board = boards[b];
 		for (int r = 0; r < 3; ++r)
 		{
 			const size_t byteIdx = bitPos >> 3;
@@ -242,7 +276,5 @@ BoardStream memoryBlockToBoards(const std::uint8_t* data, size_t byteCount, size
 
 			bitPos += 5;
 		}
-		boards.push_back(board);
 	}
-	return boards;
 }
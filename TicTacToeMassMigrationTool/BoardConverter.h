@@ -1,5 +1,6 @@
 #pragma once
 #include "BaseTypes.h"
+#include "PackedBoard.h"
 #include <string>
 #include <iostream>
 
@@ -8,5 +9,14 @@ namespace detail {
     constexpr uint8_t PATTERN_EMPTY = 0b10'001;
 }
 
+uint8_t rowToFiveBit(const Square(&row)[3]);
+void fiveBitsToRow(uint8_t bits, Square(&row)[3]);
+
+uint16_t boardToFifteenBit(const Board& board);
+Board fifteenBitToBoard(uint16_t bits);
+uint8_t countMarks(const Board& board);
+bool startsGame(const Board& board);
+
 ByteVector boardsToMemoryBlock(const BoardStream& boards);
-BoardStream memoryBlockToBoards(const std::uint8_t* data, size_t byteCount, size_t boardCount);
\ No newline at end of file
+BoardStream memoryBlockToBoards(const std::uint8_t* data, size_t byteCount, size_t boardCount);
+void memoryBlockToBoards(const std::uint8_t* data, size_t byteCount, Board* boards, size_t boardCount);
\ No newline at end of file
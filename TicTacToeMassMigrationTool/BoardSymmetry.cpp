@@ -0,0 +1,34 @@
+#include "BoardSymmetry.h"
+#include "BoardConverter.h"
+
+Board transformBoard(const Board& board, uint8_t transform) {
+    const auto& map = detail::TRANSFORMS[transform];
+    const Square* source = &board.squares[0][0];
+
+    Board result;
+    Square* target = &result.squares[0][0];
+    for (int i = 0; i < 9; i++) {
+        target[i] = source[map[i]];
+    }
+    return result;
+}
+
+uint8_t canonicalTransform(const Board* boards, size_t count) {
+    // Candidates still tied for the smallest prefix, one bit per transform
+    uint8_t candidates = 0xFF;
+    for (size_t b = 0; b < count && (candidates & (candidates - 1)); b++) {
+        uint16_t codes[8] = {};
+        uint16_t smallest = uint16_t(-1);
+        for (uint8_t t = 0; t < 8; t++) {
+            if (!(candidates & (1 << t))) continue;
+            codes[t] = boardToFifteenBit(transformBoard(boards[b], t));
+            if (codes[t] < smallest) smallest = codes[t];
+        }
+        for (uint8_t t = 0; t < 8; t++) {
+            if (codes[t] != smallest) candidates &= ~(1 << t);
+        }
+    }
+    uint8_t transform = 0;
+    while (!(candidates & (1 << transform))) transform++;
+    return transform;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "BaseTypes.h"
+
+/* ---------------------------------------------------------------------------
+ *  The 8 symmetries of the board (dihedral group D4)
+ *
+ *  Squares are indexed row-major, index = row * 3 + column.
+ *  TRANSFORMS[t][i] is the square of the source board that ends up on
+ *  square i after applying transform t. Transform t is
+ *      (t & 0b011) quarter turns clockwise, applied after
+ *      (t & 0b100) a mirror of the columns,
+ *  so t = 0 is the identity. INVERSE[t] undoes t.
+ *  Both tables are built at compile time.
+ * ------------------------------------------------------------------------- */
+
+namespace detail {
+    constexpr std::array<std::array<uint8_t, 9>, 8> makeTransforms() {
+        std::array<std::array<uint8_t, 9>, 8> table{};
+        for (int t = 0; t < 8; t++) {
+            for (int i = 0; i < 9; i++) {
+                int r = i / 3;
+                int c = i % 3;
+                for (int turn = 0; turn < (t & 0b011); turn++) {
+                    int previousRow = 2 - c;    // new[r][c] = old[2 - c][r]
+                    c = r;
+                    r = previousRow;
+                }
+                if (t & 0b100) c = 2 - c;
+                table[t][i] = uint8_t(r * 3 + c);
+            }
+        }
+        return table;
+    }
+
+    constexpr std::array<std::array<uint8_t, 9>, 8> TRANSFORMS = makeTransforms();
+
+    constexpr std::array<uint8_t, 8> makeInverse() {
+        std::array<uint8_t, 8> inverse{};
+        for (int t = 0; t < 8; t++) {
+            for (int u = 0; u < 8; u++) {
+                bool identity = true;
+                for (int i = 0; i < 9; i++) identity &= TRANSFORMS[t][TRANSFORMS[u][i]] == i;
+                if (identity) inverse[t] = uint8_t(u);
+            }
+        }
+        return inverse;
+    }
+
+    constexpr std::array<uint8_t, 8> INVERSE = makeInverse();
+
+    static_assert(INVERSE[0] == 0 && INVERSE[1] == 3 && INVERSE[4] == 4);
+}
+
+Board transformBoard(const Board& board, uint8_t transform);
+
+// The transform that maps the game to its lexicographically smallest
+// sequence of 15-bit board codes. Ties resolve to the lowest transform id.
+uint8_t canonicalTransform(const Board* boards, size_t count);
@@ -0,0 +1,68 @@
+#include "Checksum.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(_M_X64)
+#define CHECKSUM_SSE42
+#define TARGET_SSE42
+#include <intrin.h>
+#include <nmmintrin.h>
+#elif defined(__x86_64__)
+#define CHECKSUM_SSE42
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#include <nmmintrin.h>
+#endif
+
+namespace {
+	constexpr uint32_t POLYNOMIAL = 0x82F6'3B78;
+
+	constexpr std::array<uint32_t, 256> makeTable() {
+		std::array<uint32_t, 256> table{};
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t crc = i;
+			for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (crc & 1 ? POLYNOMIAL : 0);
+			table[i] = crc;
+		}
+		return table;
+	}
+
+	constexpr std::array<uint32_t, 256> TABLE = makeTable();
+
+	uint32_t crc32cSoftware(const uint8_t* data, size_t bytes, uint32_t crc) {
+		crc = ~crc;
+		for (size_t i = 0; i < bytes; i++) crc = (crc >> 8) ^ TABLE[(crc ^ data[i]) & 0xFF];
+		return ~crc;
+	}
+
+#ifdef CHECKSUM_SSE42
+	TARGET_SSE42 uint32_t crc32cHardware(const uint8_t* data, size_t bytes, uint32_t crc) {
+		uint64_t state = ~crc;
+		for (; bytes >= 8; bytes -= 8, data += 8) {
+			uint64_t word;
+			std::memcpy(&word, data, 8);
+			state = _mm_crc32_u64(state, word);
+		}
+		for (; bytes > 0; bytes--, data++) state = _mm_crc32_u8(uint32_t(state), *data);
+		return ~uint32_t(state);
+	}
+
+	bool hasSse42() {
+#if defined(_M_X64)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] >> 20) & 1;
+#else
+		return __builtin_cpu_supports("sse4.2");
+#endif
+	}
+#endif
+}
+
+uint32_t crc32c(const uint8_t* data, size_t bytes, uint32_t crc) {
+#ifdef CHECKSUM_SSE42
+	static const bool hardware = hasSse42();
+	if (hardware) return crc32cHardware(data, bytes, crc);
+#endif
+	return crc32cSoftware(data, bytes, crc);
+}
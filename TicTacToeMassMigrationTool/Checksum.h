@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/* ---------------------------------------------------------------------------
+ *  CRC-32C (Castagnoli, reflected polynomial 0x82F63B78)
+ *
+ *  crc32c(data, bytes, crc)
+ *      Checksum of `bytes` bytes, continuing from `crc` (the result of a
+ *      previous call over the preceding bytes, 0 to start).
+ *      crc32c("123456789") == 0xE3069283.
+ *
+ *  On x86-64 CPUs with SSE4.2 the crc32 instruction is used, 8 bytes per
+ *  step; the CPU is checked once at first use. Everything else uses a 256
+ *  entry table built at compile time.
+ * ------------------------------------------------------------------------- */
+
+uint32_t crc32c(const uint8_t* data, size_t bytes, uint32_t crc = 0);
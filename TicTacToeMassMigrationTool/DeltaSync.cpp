@@ -0,0 +1,153 @@
+#include "DeltaSync.h"
+#include <algorithm>
+#include <unordered_map>
+
+static uint64_t hashGame(const Game& game) {
+	return mix64(contentHash(reinterpret_cast<const uint8_t*>(game.boards.data()), game.boards.size() * sizeof(Board)));
+}
+
+std::vector<GameBlock> splitIntoBlocks(const GameList& games) {
+	using namespace detail;
+
+	std::vector<GameBlock> blocks;
+	GameBlock block{ 0, 0, 0 };
+	for (size_t i = 0; i < games.size(); i++) {
+		const uint64_t hash = hashGame(games[i]);
+		block.fingerprint = mix64(block.fingerprint ^ hash);
+		block.games++;
+		const bool cut = (hash & (SYNC_BLOCK_GAMES - 1)) == 0 && block.games >= SYNC_MIN_BLOCK_GAMES;
+		if (cut || block.games == SYNC_MAX_BLOCK_GAMES || i + 1 == games.size()) {
+			blocks.push_back(block);
+			block = { i + 1, 0, 0 };
+		}
+	}
+	return blocks;
+}
+
+ByteVector serializeFingerprints(const std::vector<GameBlock>& blocks) {
+	ByteVector data(8 * (blocks.size() + 1));
+	putU64(data.data(), blocks.size());
+	for (size_t i = 0; i < blocks.size(); i++) putU64(data.data() + 8 * (i + 1), blocks[i].fingerprint);
+	return data;
+}
+
+std::vector<uint64_t> deserializeFingerprints(const ByteVector& data) {
+	if (data.size() < 8 || data.size() % 8 != 0) return {};
+	const uint64_t count = getU64(data.data());
+	if (count != data.size() / 8 - 1) return {}; // not 8 * (count + 1), which a huge count overflows
+	std::vector<uint64_t> fingerprints(count);
+	for (size_t i = 0; i < count; i++) fingerprints[i] = getU64(data.data() + 8 * (i + 1));
+	return fingerprints;
+}
+
+ByteVector encodeDelta(const GameList& games, const std::vector<uint64_t>& remoteFingerprints, const EncodeOptions& options) {
+	return encodeDelta(games, splitIntoBlocks(games), remoteFingerprints, options);
+}
+
+ByteVector encodeDelta(const GameList& games, const std::vector<GameBlock>& blocks, const std::vector<uint64_t>& remoteFingerprints,
+	const EncodeOptions& options) {
+	using namespace detail;
+
+	std::unordered_map<uint64_t, uint32_t> remoteBlocks;
+	remoteBlocks.reserve(remoteFingerprints.size());
+	for (size_t i = 0; i < remoteFingerprints.size(); i++) remoteBlocks.emplace(remoteFingerprints[i], uint32_t(i));
+	const uint8_t idBits = bitWidth(remoteFingerprints.size());
+
+	size_t longestGame = 0;
+	for (const Game& game : games) longestGame = std::max(longestGame, game.boards.size());
+	const uint8_t lengthBits = bitWidth(longestGame + 1);
+
+	ByteVector script;
+	BitWriter writer(script);
+	BoardStream literals;
+	for (const GameBlock& block : blocks) {
+		auto remote = remoteBlocks.find(block.fingerprint);
+		if (remote != remoteBlocks.end()) {
+			writer.write(1, 1);
+			writer.write(remote->second, idBits);
+			continue;
+		}
+		writer.write(0, 1);
+		writer.write(block.games, SYNC_COUNT_BITS);
+		for (size_t i = block.firstGame; i < block.firstGame + block.games; i++) {
+			writer.write(games[i].boards.size(), lengthBits);
+			literals.insert(literals.end(), games[i].boards.begin(), games[i].boards.end());
+		}
+	}
+	writer.flush();
+
+	const ByteVector frame = encodeBoards(literals, options);
+	ByteVector delta(SYNC_HEADER_BYTES);
+	putU64(delta.data(), blocks.size());
+	putU64(delta.data() + 8, remoteFingerprints.size());
+	putU64(delta.data() + 16, script.size());
+	putU64(delta.data() + 24, lengthBits);
+	delta.reserve(SYNC_HEADER_BYTES + script.size() + frame.size());
+	delta.insert(delta.end(), script.begin(), script.end());
+	delta.insert(delta.end(), frame.begin(), frame.end());
+	return delta;
+}
+
+bool applyDelta(GameList& games, const ByteVector& delta) {
+	using namespace detail;
+
+	if (delta.size() < SYNC_HEADER_BYTES) return false;
+	const uint64_t blockCount = getU64(delta.data());
+	const uint64_t remoteCount = getU64(delta.data() + 8);
+	const uint64_t scriptBytes = getU64(delta.data() + 16);
+	const uint64_t lengthBits = getU64(delta.data() + 24);
+	if (scriptBytes > delta.size() - SYNC_HEADER_BYTES || lengthBits > SYNC_MAX_LENGTH_BITS) return false;
+	if (blockCount > scriptBytes * 8) return false; // every entry takes at least one bit
+
+	const std::vector<GameBlock> ownBlocks = splitIntoBlocks(games);
+	if (remoteCount != ownBlocks.size()) return false;
+	const uint8_t idBits = bitWidth(ownBlocks.size());
+
+	const ByteVector frame(delta.begin() + SYNC_HEADER_BYTES + scriptBytes, delta.end());
+	const BoardStream literals = decodeBoards(frame);
+	size_t nextLiteral = 0;
+
+	GameList patched;
+	BitReader reader(delta.data() + SYNC_HEADER_BYTES, scriptBytes);
+	for (uint64_t block = 0; block < blockCount; block++) {
+		if (reader.read(1)) {
+			const size_t id = reader.read(idBits);
+			if (id >= ownBlocks.size()) return false;
+			const GameBlock& own = ownBlocks[id];
+			patched.insert(patched.end(), games.begin() + own.firstGame, games.begin() + own.firstGame + own.games);
+			continue;
+		}
+		const size_t count = reader.read(SYNC_COUNT_BITS);
+		for (size_t i = 0; i < count; i++) {
+			const size_t length = reader.read(uint8_t(lengthBits));
+			if (length > literals.size() - nextLiteral) return false;
+			patched.push_back({ BoardStream(literals.begin() + nextLiteral, literals.begin() + nextLiteral + length) });
+			nextLiteral += length;
+		}
+	}
+	if (reader.position() > scriptBytes * 8 || nextLiteral != literals.size()) return false;
+
+	games = std::move(patched);
+	return true;
+}
+
+bool syncOutGames(const GameList& games, std::string IP, size_t port, const EncodeOptions& options) {
+	// Cut before listening, the receiver's request only decides which blocks are literal
+	const std::vector<GameBlock> blocks = splitIntoBlocks(games);
+	bool understood = false;
+	const bool replied = serveData(IP, uint32_t(port), [&](const ByteVector& fingerprintData) {
+		const std::vector<uint64_t> fingerprints = deserializeFingerprints(fingerprintData);
+		understood = !fingerprints.empty() || fingerprintData.size() == 8;
+		if (!understood) return ByteVector{};
+
+		ByteVector delta = encodeDelta(games, blocks, fingerprints, options);
+		std::cout << "Delta: " << delta.size() << " Bytes for " << games.size() << " games.\n";
+		return delta;
+	});
+	return replied && understood;
+}
+
+bool syncInGames(GameList& games, std::string IP, size_t port) {
+	const ByteVector delta = requestData(IP, uint32_t(port), serializeFingerprints(splitIntoBlocks(games)));
+	return applyDelta(games, delta);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "TicTacToeMassMigrationTool.h"
+
+/* ---------------------------------------------------------------------------
+ *  Incremental sync of a GameList between two endpoints
+ *
+ *  Blocks
+ *  ------
+ *    Both sides cut their GameList into blocks of whole games and fingerprint
+ *    every block with a 64-bit hash of its games. A block ends after a game
+ *    whose hash has its low bits clear (about one game in SYNC_BLOCK_GAMES),
+ *    but never before SYNC_MIN_BLOCK_GAMES games and always at
+ *    SYNC_MAX_BLOCK_GAMES. Since the cut points depend on the games and not
+ *    on their positions, an inserted or deleted game only changes the blocks
+ *    around it and the rest of the list still matches. A fingerprint costs 8
+ *    bytes per block, about one bit per game.
+ *
+ *  Protocol
+ *  --------
+ *    syncInGames (receiver)             syncOutGames (sender)
+ *      fingerprints of its blocks  ->   listening on `port`
+ *                                  <-   delta
+ *      patches its GameList
+ *    Both legs run over the one connection of a requestData/serveData
+ *    exchange, so they resume and verify like any other transfer.
+ *
+ *  Delta
+ *  -----
+ *      [0..8)    blocks        : number of sender blocks
+ *      [8..16)   remoteBlocks  : number of fingerprints the delta was made for
+ *      [16..24)  scriptBytes   : size of the script
+ *      [24..32)  lengthBits    : bits per literal game length
+ *      script, frame
+ *    The script has one entry per sender block, LSB-first:
+ *      1 + idBits id                   : copy the receiver's block `id`
+ *      0 + 9 bit count,
+ *        count x lengthBits boards     : take the next `count` games of the
+ *                                        frame, of that many boards each
+ *    where idBits is the number of bits needed for remoteBlocks. The frame is
+ *    encodeBoards() of the boards of every literal game in order. The stored
+ *    lengths cut it back into games exactly as they were sent, whatever the
+ *    boards look like.
+ *
+ *  applyDelta rebuilds the sender's list from its own blocks and the frame
+ *  and returns false, leaving `games` untouched, if the delta does not fit.
+ * ------------------------------------------------------------------------- */
+
+namespace detail {
+	constexpr size_t SYNC_BLOCK_GAMES = 1 << 6;
+	constexpr size_t SYNC_MIN_BLOCK_GAMES = 1 << 4;
+	constexpr size_t SYNC_MAX_BLOCK_GAMES = 1 << 8;
+	constexpr size_t SYNC_HEADER_BYTES = 32;
+	constexpr uint8_t SYNC_COUNT_BITS = 9;
+	constexpr uint8_t SYNC_MAX_LENGTH_BITS = 32;
+	static_assert(SYNC_MAX_BLOCK_GAMES < 1 << SYNC_COUNT_BITS);
+}
+
+struct GameBlock {
+	size_t firstGame;
+	size_t games;
+	uint64_t fingerprint;
+};
+
+std::vector<GameBlock> splitIntoBlocks(const GameList& games);
+ByteVector serializeFingerprints(const std::vector<GameBlock>& blocks);
+std::vector<uint64_t> deserializeFingerprints(const ByteVector& data);
+
+ByteVector encodeDelta(const GameList& games, const std::vector<uint64_t>& remoteFingerprints, const EncodeOptions& options = {});
+// Same, for blocks the caller already cut with splitIntoBlocks(games)
+ByteVector encodeDelta(const GameList& games, const std::vector<GameBlock>& blocks, const std::vector<uint64_t>& remoteFingerprints,
+	const EncodeOptions& options = {});
+bool applyDelta(GameList& games, const ByteVector& delta);
+
+bool syncOutGames(const GameList& games, std::string IP, size_t port, const EncodeOptions& options = {});
+bool syncInGames(GameList& games, std::string IP, size_t port);
@@ -0,0 +1,59 @@
+#include "GameDictionary.h"
+#include "BoardConverter.h"
+#include "BoardSymmetry.h"
+#include "BitStream.h"
+
+static uint16_t codeAt(const Board& board, uint8_t transform) {
+    return boardToFifteenBit(transform == 0 ? board : transformBoard(board, transform));
+}
+
+GameDictionary::GameDictionary(const BoardStream& boards) : boards(boards), slots(1 << 16) {}
+
+uint64_t GameDictionary::hashGame(size_t start, size_t count, uint8_t transform) const {
+    // FNV-1a over the board codes, then a splitmix64 finalizer so the low
+    // bits used for the slot index are well mixed
+    uint64_t hash = 0xcbf2'9ce4'8422'2325;
+    for (size_t i = start; i < start + count; i++) {
+        hash ^= codeAt(this->boards[i], transform);
+        hash *= 0x0000'0100'0000'01b3;
+    }
+    return mix64(hash);
+}
+
+bool GameDictionary::sameGame(const Entry& entry, size_t start, size_t count, uint8_t transform) const {
+    if (entry.count != count) return false;
+    for (size_t i = 0; i < count; i++) {
+        if (codeAt(this->boards[entry.start + i], entry.transform) != codeAt(this->boards[start + i], transform)) return false;
+    }
+    return true;
+}
+
+void GameDictionary::grow() {
+    std::vector<Slot> old(this->slots.size() * 2);
+    old.swap(this->slots);
+    const size_t mask = this->slots.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.id == EMPTY) continue;
+        size_t index = slot.hash & mask;
+        while (this->slots[index].id != EMPTY) index = (index + 1) & mask;
+        this->slots[index] = slot;
+    }
+}
+
+uint32_t GameDictionary::insert(size_t start, size_t count, uint8_t transform) {
+    const uint64_t hash = hashGame(start, count, transform);
+    const size_t mask = this->slots.size() - 1;
+
+    size_t index = hash & mask;
+    for (; this->slots[index].id != EMPTY; index = (index + 1) & mask) {
+        const Slot& slot = this->slots[index];
+        if (slot.hash == hash && sameGame(this->entries[slot.id], start, count, transform)) return slot.id;
+    }
+
+    if (this->entries.size() >= EMPTY - 1) throw std::string("Too many distinct games");
+    const uint32_t id = uint32_t(this->entries.size());
+    this->entries.push_back({ start, uint32_t(count), transform });
+    this->slots[index] = { hash, id };
+    if (this->entries.size() * 2 > this->slots.size()) grow();
+    return id;
+}
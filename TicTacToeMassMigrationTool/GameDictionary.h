@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "BaseTypes.h"
+
+/* ---------------------------------------------------------------------------
+ *  Dictionary of the distinct games in a BoardStream
+ *
+ *  Games are identified by a range of boards in the stream plus the symmetry
+ *  transform they are coded with, so two games are equal when their
+ *  transformed 15-bit board codes are equal. Ids are handed out in insertion
+ *  order starting at 0.
+ *
+ *  The table is open addressing with linear probing over 16-byte slots that
+ *  hold the full 64-bit hash, so probing never touches the boards; the
+ *  boards are only compared when the hashes match. The table doubles at 50%
+ *  load. Memory is 32-64 bytes of slots plus one 16-byte entry per distinct
+ *  game, independent of the game length.
+ *
+ *  insert(start, count, transform)
+ *      Returns the id of the game made of boards [start, start + count), a
+ *      new id if no equal game was inserted before.
+ * ------------------------------------------------------------------------- */
+
+class GameDictionary {
+	struct Slot {
+		uint64_t hash = 0;
+		uint32_t id = EMPTY;
+	};
+	struct Entry {
+		size_t start;
+		uint32_t count;
+		uint8_t transform;
+	};
+	const BoardStream& boards;
+	std::vector<Slot> slots;
+	std::vector<Entry> entries;
+
+	uint64_t hashGame(size_t start, size_t count, uint8_t transform) const;
+	bool sameGame(const Entry& entry, size_t start, size_t count, uint8_t transform) const;
+	void grow();
+public:
+	static constexpr uint32_t EMPTY = uint32_t(-1);
+
+	explicit GameDictionary(const BoardStream& boards);
+
+	uint32_t insert(size_t start, size_t count, uint8_t transform);
+	size_t size() const { return entries.size(); }
+};
@@ -1,4 +1,5 @@
 #include "HuffmanTree.h"
+#include <algorithm>
 
 uint16_t HuffmanTree::getBoardAtPos(const uint8_t* data, size_t bytes, size_t bitPos) {
     size_t byteIdx = bitPos >> 3;
@@ -44,13 +45,30 @@ bool HuffmanTree::DFSE(const std::shared_ptr<Node> node, const std::shared_ptr<N
     return DFSE(node->childOne, otherNode->childOne) && DFSE(node->childTwo, otherNode->childTwo);
 }
 
-HuffmanTree::HuffmanTree(const ByteVector& raw) {
-    // 1. Build frequency map
-    std::unordered_map<uint16_t, size_t> freq;
+void HuffmanTree::DFSCode(const std::shared_ptr<Node> node, uint64_t bits, uint8_t depth) {
+    if (node->childOne == nullptr) {
+        this->codeBits[node->value] = bits;
+        this->codeLengths[node->value] = depth;
+        return;
+    }
+    if (depth == 64) throw std::string("Huffman code exceeds 64 bits");
+    DFSCode(node->childOne, bits, depth + 1);
+    DFSCode(node->childTwo, bits | uint64_t(1) << depth, depth + 1);
+}
+
+std::vector<size_t> HuffmanTree::countBoards(const ByteVector& raw) {
+    std::vector<size_t> freq(SYMBOL_COUNT, 0);
     const size_t totalBits = raw.size() * 8;
     for (size_t bitPos = 0; bitPos + 15 <= totalBits; bitPos += 15) {
         ++freq[getBoardAtPos(raw.data(), raw.size(), bitPos)];
     }
+    return freq;
+}
+
+HuffmanTree::HuffmanTree(const ByteVector& raw) : HuffmanTree(countBoards(raw)) {}
+
+HuffmanTree::HuffmanTree(const std::vector<size_t>& frequencies) {
+    // 1. Frequencies are indexed by the 15-bit board code
 
     // 2. Build min-heap of nodes
     struct PQEntry {
@@ -60,15 +78,16 @@ HuffmanTree::HuffmanTree(const ByteVector& raw) {
     };
     std::priority_queue<PQEntry, std::vector<PQEntry>, std::greater<>> pq;
 
-    for (auto keyValuePair : freq) {
+    for (size_t board = 0; board < frequencies.size(); board++) {
+        if (frequencies[board] == 0) continue;
         auto node = std::make_shared<Node>();
-        node->value = keyValuePair.first;
-        this->leafNodes[node->value] = node;
+        node->value = uint16_t(board);
         PQEntry pqe;
         pqe.node = std::move(node);
-        pqe.frequency = keyValuePair.second;
+        pqe.frequency = frequencies[board];
         pq.push(pqe);
     }
+    if (pq.empty()) throw std::string("No boards to build a Huffman tree from");
 
     // 3. Merge
     while (pq.size() > 1) {
@@ -77,22 +96,25 @@ HuffmanTree::HuffmanTree(const ByteVector& raw) {
         const PQEntry& e1 = pq.top(); 
         size_t f1 = e1.frequency;
         parent->childOne = e1.node;
-        parent->childOne->parent = parent;
         pq.pop();
 
         const PQEntry& e2 = pq.top(); 
         size_t f2 = e2.frequency;
         parent->childTwo = e2.node;
-        parent->childTwo->parent = parent;
         pq.pop();
 
         pq.push({ f1 + f2 ,std::move(parent) });
     }
     this->head = pq.top().node;
+
+    // 4. Code table, bit i of a code is the branch taken at depth i
+    this->codeBits.assign(SYMBOL_COUNT, 0);
+    this->codeLengths.assign(SYMBOL_COUNT, 0);
+    DFSCode(this->head, 0, 0);
 }
 
 HuffmanTree::HuffmanTree(const std::uint8_t* raw, size_t byteCount) {
-    std::shared_ptr<Node> node;
+    Node* node = nullptr;
     const size_t totalBits = byteCount * 8;
     for (size_t bitPos = 0; bitPos < totalBits; bitPos++) {
         uint8_t byte = raw[bitPos >> 3];
@@ -105,9 +127,8 @@ HuffmanTree::HuffmanTree(const std::uint8_t* raw, size_t byteCount) {
             newNode->value = board;
 
             if (node == nullptr) {
-                node = newNode;
-                this->head = node;
-                continue;
+                this->head = newNode;
+                return;
             }
 
             if (node->childOne == nullptr) {
@@ -124,8 +145,8 @@ HuffmanTree::HuffmanTree(const std::uint8_t* raw, size_t byteCount) {
             auto newNode = std::make_shared<Node>();
             newNode->parent = node;
             if (node == nullptr) {
-                node = newNode;
-                this->head = node;
+                this->head = newNode;
+                node = newNode.get();
                 continue;
             }
             if (node->childOne == nullptr) {
@@ -133,7 +154,7 @@ HuffmanTree::HuffmanTree(const std::uint8_t* raw, size_t byteCount) {
             } else {
                 node->childTwo = newNode;
             }
-            node = newNode;
+            node = newNode.get();
         }
     }
 }
@@ -148,39 +169,34 @@ void HuffmanTree::serialize(ByteVector& raw) {
     }
     ByteVector serializeData;
     serializeData.reserve(raw.size());
-    size_t newPos = 0;
+    BitWriter writer(serializeData);
     const size_t totalBits = raw.size() * 8;
     for (size_t bitPos = 0; bitPos + 15 <= totalBits; bitPos += 15) {
         uint16_t board = getBoardAtPos(raw.data(), raw.size(), bitPos);
 
-        if (this->leafNodes.find(board) == this->leafNodes.end()) throw std::string("Leaf node do not exist");
-
-        std::shared_ptr<Node> startNode = this->leafNodes[board];
-        std::shared_ptr<Node> node = startNode;
-
-        size_t depth = 0;
-        while (node->parent != nullptr) {
-            node = node->parent;
-            ++depth;
-        }
+        if (this->codeLengths[board] == 0) throw std::string("Leaf node do not exist");
 
-        node = startNode;
-        if(serializeData.size() < ((newPos + depth + 7) >> 3)) serializeData.resize(((newPos + depth + 7) >> 3));
-        for(int64_t i = newPos + depth - 1; i >= int64_t(newPos); i--) {
-            if (node == node->parent->childTwo) {
-                serializeData[i >> 3] |= 1 << (i & 0b111);
-            }
-            node = node->parent;
-        }
-        newPos += depth;
+        encode(board, writer);
     }
+    writer.flush();
     raw = std::move(serializeData);
 }
 
+size_t HuffmanTree::encodedBits(const std::vector<size_t>& frequencies) const {
+    size_t bits = 0;
+    for (size_t board = 0; board < frequencies.size(); board++) {
+        bits += frequencies[board] * this->codeLengths[board];
+    }
+    return bits;
+}
+
 ByteVector HuffmanTree::deserialization(const std::uint8_t* raw, size_t byteCount, size_t boardCount) {
     ByteVector deserializeData;
-    if (byteCount <= 2) {
-        writeBoardAtPos(deserializeData, 0, this->head->value, 15);
+    if (this->head->childOne == nullptr) {
+        // Single symbol stream, the code is zero bits long
+        for (size_t b = 0; b < boardCount; b++) {
+            writeBoardAtPos(deserializeData, b * 15, this->head->value, 15);
+        }
         return deserializeData;
     }
     deserializeData.reserve(byteCount*2u); // Approximate size
@@ -212,3 +228,67 @@ ByteVector HuffmanTree::getHuffmanTree() {
     DFSC(node, data, bitPos);
     return data;
 }
+
+uint32_t HuffmanDecoder::parse(BitReader& reader, size_t& bitsLeft, uint8_t depth) {
+    // Codes are at most 64 bits long, so no valid tree is deeper
+    if (bitsLeft == 0 || depth > 64) return INVALID;
+    bitsLeft--;
+    if (reader.read(1)) {
+        if (bitsLeft < 15) return INVALID;
+        bitsLeft -= 15;
+        return LEAF | uint32_t(reader.read(15));
+    }
+    const uint32_t index = uint32_t(this->nodes.size());
+    if (index >= HuffmanTree::SYMBOL_COUNT) return INVALID;
+    this->nodes.push_back({ INVALID, INVALID });
+    for (int branch = 0; branch < 2; branch++) {
+        const uint32_t child = parse(reader, bitsLeft, depth + 1);
+        if (child == INVALID) return INVALID;
+        this->nodes[index][branch] = child;
+    }
+    return index;
+}
+
+bool HuffmanDecoder::load(const std::uint8_t* raw, size_t byteCount) {
+    this->nodes.clear();
+    BitReader reader(raw, byteCount);
+    size_t bitsLeft = byteCount * 8;
+    this->root = parse(reader, bitsLeft, 0);
+    if (this->root == INVALID) return false;
+    if (this->root & LEAF) return true;
+
+    // Walk every LOOKUP_BITS wide prefix down the tree, bit i of a code is the branch at depth i
+    for (uint32_t prefix = 0; prefix < this->lookup.size(); prefix++) {
+        uint32_t node = this->root;
+        uint32_t length = 0;
+        while (!(node & LEAF) && length < LOOKUP_BITS) {
+            node = this->nodes[node][(prefix >> length) & 1];
+            length++;
+        }
+        this->lookup[prefix] = node & LEAF ? node | length << 16 : node;
+    }
+    return true;
+}
+
+bool HuffmanDecoder::decode(const std::uint8_t* data, size_t byteCount, uint16_t* out, size_t symbolCount, size_t startBit) const {
+    if (this->root == INVALID) return false;
+    if (this->root & LEAF) {
+        // Single symbol stream, the code is zero bits long
+        std::fill(out, out + symbolCount, uint16_t(this->root & 0x7FFF));
+        return true;
+    }
+
+    BitReader reader(data, byteCount);
+    reader.skip(startBit);
+    for (size_t i = 0; i < symbolCount; i++) {
+        uint32_t entry = this->lookup[reader.peek(LOOKUP_BITS)];
+        if (entry & LEAF) {
+            reader.skip((entry >> 16) & 0x7F);
+        } else {
+            reader.skip(LOOKUP_BITS);
+            while (!(entry & LEAF)) entry = this->nodes[entry][reader.read(1)];
+        }
+        out[i] = uint16_t(entry & 0x7FFF);
+    }
+    return reader.position() <= byteCount * 8;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <unordered_map>
 #include <memory>
@@ -8,30 +9,77 @@
 #include <iostream>
 
 #include "BaseTypes.h"
+#include "BitStream.h"
 
 class HuffmanTree {
 	struct Node {
 		uint16_t value = uint16_t(-1);
 
-		std::shared_ptr<Node> parent = nullptr;
+		Node* parent = nullptr; // Only set while parsing a serialized tree
 		std::shared_ptr<Node> childOne = nullptr;
 		std::shared_ptr<Node> childTwo = nullptr;
 	};
-	std::unordered_map<uint16_t, std::shared_ptr <Node>> leafNodes;
 	std::shared_ptr<Node> head = nullptr;
-	uint16_t getBoardAtPos(const uint8_t* data, size_t bytes, size_t bitPos);
+	std::vector<uint64_t> codeBits;
+	std::vector<uint8_t> codeLengths;
+	static uint16_t getBoardAtPos(const uint8_t* data, size_t bytes, size_t bitPos);
+	static std::vector<size_t> countBoards(const ByteVector& raw);
 	void writeBoardAtPos(ByteVector& data, size_t bitPos, uint16_t board, size_t size);
 
 	void DFSC(std::shared_ptr<Node> node, ByteVector& data, size_t& bitPos);
 	bool DFSE(const std::shared_ptr<Node> node, const std::shared_ptr<Node> otherNode) const;
+	void DFSCode(const std::shared_ptr<Node> node, uint64_t bits, uint8_t depth);
 public:
+	static constexpr size_t SYMBOL_COUNT = 1 << 15;
+
 	HuffmanTree(const ByteVector& raw);
+	HuffmanTree(const std::vector<size_t>& frequencies);
 	HuffmanTree(const std::uint8_t* raw, size_t byteCount);
 
 	bool operator==(const HuffmanTree& other) const;
 
 	void serialize(ByteVector& raw);
+	void encode(uint16_t board, BitWriter& writer) const { writer.write(codeBits[board], codeLengths[board]); }
+	uint8_t codeLength(uint16_t board) const { return codeLengths[board]; }
+	size_t encodedBits(const std::vector<size_t>& frequencies) const;
 	ByteVector deserialization(const std::uint8_t* raw, size_t byteCount, size_t boardCount);
 	ByteVector getHuffmanTree();
 };
 
+/* ---------------------------------------------------------------------------
+ *  HuffmanDecoder
+ *
+ *  Allocation free counterpart of HuffmanTree::deserialization for repeated
+ *  decoding. The serialized tree is parsed into a flat node array and a
+ *  LOOKUP_BITS wide table that resolves every code of at most LOOKUP_BITS
+ *  bits in one step; longer codes continue from the table entry down the
+ *  node array one bit at a time.
+ *
+ *  load(raw, byteCount)
+ *      Parses a tree written by HuffmanTree::getHuffmanTree(). Returns false
+ *      on a malformed tree. An empty tree is not valid.
+ *
+ *  decode(data, byteCount, out, symbolCount, startBit)
+ *      Writes `symbolCount` 15-bit symbols to `out`, starting at bit
+ *      `startBit` of data. Returns false if the codes run past byteCount.
+ *
+ *  The node array keeps its capacity across load() calls, so once a decoder
+ *  has seen its largest tree it does not allocate again.
+ * ------------------------------------------------------------------------- */
+
+class HuffmanDecoder {
+	static constexpr uint8_t LOOKUP_BITS = 10;
+	static constexpr uint32_t LEAF = 1u << 31;
+	static constexpr uint32_t INVALID = ~0u;
+
+	// Children of internal node i, either another node index or LEAF | symbol
+	std::vector<std::array<uint32_t, 2>> nodes;
+	// LEAF | length << 16 | symbol, or the node index reached after LOOKUP_BITS bits
+	std::array<uint32_t, 1 << LOOKUP_BITS> lookup{};
+	uint32_t root = INVALID;
+
+	uint32_t parse(BitReader& reader, size_t& bitsLeft, uint8_t depth);
+public:
+	bool load(const std::uint8_t* raw, size_t byteCount);
+	bool decode(const std::uint8_t* data, size_t byteCount, uint16_t* out, size_t symbolCount, size_t startBit = 0) const;
+};
@@ -1,53 +1,592 @@
 #include "NetworkStreamHandler.h"
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <optional>
 using asio::ip::tcp;
 
-ByteVector getData(std::string IP, uint32_t port) {
-    try {
-        asio::io_context io;
+/* ---------------------------------------------------------------------------
+ *  Resumable chunked transfer
+ *
+ *  All integers on the wire are 64-bit big-endian.
+ *
+ *  Handshake (sender -> receiver)
+ *  ------------------------------
+ *      contentHash  : contentHash() of the whole payload, identifies the stream
+ *      totalBytes   : payload size
+ *      chunkBytes   : size of every chunk except possibly the last
+ *
+ *  Handshake (receiver -> sender)
+ *  ------------------------------
+ *      resumeChunk  : number of chunks the receiver already holds for this
+ *                     (contentHash, totalBytes, chunkBytes). 0 for a new stream.
+ *
+ *  Transfer
+ *  --------
+ *    -> The sender streams chunks from resumeChunk onward, keeping at most
+ *       ACK_WINDOW chunks unacknowledged.
+ *    -> After storing a chunk the receiver answers with the number of chunks
+ *       it now holds.
+ *    -> When every chunk is acknowledged the receiver compares the hash it
+ *       kept up to date chunk by chunk and answers 1 (intact) or 0
+ *       (mismatch, partial state discarded).
+ *
+ *  If the connection drops both sides keep their state: the sender reconnects
+ *  (up to MAX_ATTEMPTS times) and the receiver, still listening, answers the
+ *  new handshake with the last acknowledged chunk, so only the missing chunks
+ *  are sent again. The receiver only counts connections from the expected
+ *  address that get through the handshake against MAX_ATTEMPTS, so stray
+ *  connections cannot end a transfer. A stalled link counts as dropped: every connect, read and
+ *  write must finish within IO_TIMEOUT or the socket is closed under it. The
+ *  receiver refuses a totalBytes or chunkBytes above MAX_PAYLOAD_BYTES before
+ *  allocating.
+ *
+ *  The protocol is written once, as coroutines (asyncGetData/asyncSendData)
+ *  that suspend on every socket operation, so one thread can drive any number
+ *  of transfers. Every transfer runs on its own strand of the executor it is
+ *  awaited on, so that executor may be multi-threaded. A receiver binds its
+ *  port before moving there, so it listens as soon as it starts. getData/sendData run
+ *  them to completion on a private io_context.
+ *
+ *  Request and reply
+ *  -----------------
+ *    asyncRequestData sends a request and receives the reply on the same
+ *    connection; asyncServeData, listening, receives it and answers with
+ *    respond(request). Both legs use the transfer above with the roles
+ *    swapped for the reply. After a drop the client reconnects and repeats
+ *    the request, which the server already holds and answers at once, and
+ *    the reply resumes where it stopped.
+ *
+ *    respond is called once per request, on a worker thread, and may take
+ *    longer than IO_TIMEOUT. Between the two legs the server writes
+ *    REPLY_PENDING every KEEPALIVE_INTERVAL while respond runs and
+ *    REPLY_READY once the reply and its hash are there, so the client's
+ *    deadline only expires when the server stops talking.
+ *
+ *  Fan-out
+ *  -------
+ *    asyncSendDataToAll starts one asyncSendData per destination on the same
+ *    executor and waits for all of them. Every destination has its own
+ *    connection, window and retries, so a slow or unreachable receiver only
+ *    delays its own TransferStatus. The payload is hashed once and shared,
+ *    not copied.
+ *
+ *  Hashing
+ *  -------
+ *    The overloads without a hash run contentHash over the payload on the
+ *    calling thread before connecting. Callers with a worker pool compute it
+ *    there, next to whatever produced the payload, and pass it in.
+ * ------------------------------------------------------------------------- */
 
-        tcp::acceptor acceptor(io, tcp::endpoint(tcp::v4(), port));
-        std::cout << "Server listening on port " << port << "...\n";
+static asio::awaitable<void> writeU64(tcp::socket& socket, uint64_t value) {
+    uint8_t bytes[8];
+    for (int i = 0; i < 8; i++) bytes[i] = uint8_t(value >> 8 * (7 - i));
+    co_await asio::async_write(socket, asio::buffer(bytes), asio::use_awaitable);
+}
+
+static asio::awaitable<uint64_t> readU64(tcp::socket& socket) {
+    uint8_t bytes[8];
+    co_await asio::async_read(socket, asio::buffer(bytes), asio::use_awaitable);
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) value = value << 8 | bytes[i];
+    co_return value;
+}
+
+// Closes the socket when the operation started by the last arm() runs longer
+// than IO_TIMEOUT, which fails that operation with operation_aborted
+class Deadline {
+public:
+    explicit Deadline(tcp::socket& socket)
+        : state(std::make_shared<State>(socket)) {
+        watch(state);
+    }
+    ~Deadline() {
+        state->stopped = true;
+        state->timer.cancel();
+    }
+    Deadline(const Deadline&) = delete;
+    Deadline& operator=(const Deadline&) = delete;
+
+    void arm() { state->timer.expires_after(detail::IO_TIMEOUT); }
+    bool expired() const { return state->expired; }
+
+private:
+    struct State {
+        explicit State(tcp::socket& socket)
+            : socket(socket), timer(socket.get_executor(), asio::steady_timer::time_point::max()) {}
+        tcp::socket& socket;
+        asio::steady_timer timer;
+        bool stopped = false;
+        bool expired = false;
+    };
+
+    // Re-armed after every wake-up; arm() cancels the pending wait, which lands here early
+    static void watch(std::shared_ptr<State> state) {
+        state->timer.async_wait([state](const asio::error_code&) {
+            if (state->stopped) return;
+            if (state->timer.expiry() <= asio::steady_timer::clock_type::now()) {
+                state->expired = true;
+                asio::error_code ignored;
+                state->socket.close(ignored);
+                return;
+            }
+            watch(state);
+        });
+    }
+
+    std::shared_ptr<State> state;
+};
+
+// Runs a transfer on its own strand of the calling executor. Its sockets, its
+// Deadline timers and the coroutine arming them are then never run at the
+// same time, however many threads run the executor.
+template <typename T>
+static asio::awaitable<T> onStrand(asio::awaitable<T> task) {
+    auto strand = asio::make_strand(co_await asio::this_coro::executor);
+    co_return co_await asio::co_spawn(strand, std::move(task), asio::use_awaitable);
+}
+
+// Drives a coroutine to completion on a private io_context
+template <typename T>
+static T runBlocking(asio::awaitable<T> task) {
+    asio::io_context io;
+    std::future<T> result = asio::co_spawn(io, std::move(task), asio::use_future);
+    io.run();
+    return result.get();
+}
+
+uint64_t contentHash(const uint8_t* data, size_t bytes, uint64_t hash) {
+    // FNV-1a, 64 bit
+    for (size_t i = 0; i < bytes; i++) {
+        hash ^= data[i];
+        hash *= 0x0000'0100'0000'01b3;
+    }
+    return hash;
+}
+
+// What a receiver holds of a stream between connections
+struct ReceiveState {
+    ByteVector data;
+    bool resumable = false;
+    uint64_t hash = 0;
+    uint64_t chunkBytes = 0;
+    uint64_t chunksReceived = 0;
+    uint64_t receivedHash = detail::CONTENT_HASH_SEED; // over the chunks held, which always arrive in order
+    int attempts = 0; // connections that got through the handshake, each one of MAX_ATTEMPTS
+};
+
+// Receiver side of one connection, true once `state` holds the intact payload
+static asio::awaitable<bool> receiveOn(tcp::socket& socket, Deadline& deadline, ReceiveState& state) {
+    using namespace detail;
+
+    deadline.arm();
+    uint64_t hash = co_await readU64(socket);
+    uint64_t len = co_await readU64(socket);
+    uint64_t chunkBytes = co_await readU64(socket);
+    if (chunkBytes == 0 || chunkBytes > MAX_PAYLOAD_BYTES) throw std::runtime_error("Invalid chunk size");
+    if (len > MAX_PAYLOAD_BYTES) throw std::runtime_error("Payload of " + std::to_string(len) + " Bytes exceeds the limit");
+
+    if (!state.resumable || hash != state.hash || len != state.data.size() || chunkBytes != state.chunkBytes) {
+        state.hash = hash;
+        state.chunkBytes = chunkBytes;
+        state.chunksReceived = 0;
+        state.receivedHash = CONTENT_HASH_SEED;
+        state.data.assign(len, 0);
+        state.resumable = true;
+    }
+    else {
+        std::cout << "Resuming transfer at chunk " << state.chunksReceived << '\n';
+    }
+    co_await writeU64(socket, state.chunksReceived);
+    state.attempts++;
 
-        tcp::socket socket(io);
-        acceptor.accept(socket); // wait for client to connect
-		if (socket.remote_endpoint().address() != asio::ip::make_address(IP)) {
-			std::cerr << "Connection from unauthorized IP: " << socket.remote_endpoint().address() << '\n';
-			return {};
-		}
-        std::cout << "Client connected from " << socket.remote_endpoint() << '\n';
+    const uint64_t chunkCount = len / chunkBytes + (len % chunkBytes != 0);
+    while (state.chunksReceived < chunkCount) {
+        size_t offset = state.chunksReceived * chunkBytes;
+        size_t size = std::min<size_t>(chunkBytes, len - offset);
+        deadline.arm();
+        co_await asio::async_read(socket, asio::buffer(state.data.data() + offset, size), asio::use_awaitable);
+        state.receivedHash = contentHash(state.data.data() + offset, size, state.receivedHash);
+        state.chunksReceived++;
+        co_await writeU64(socket, state.chunksReceived);
+    }
+
+    bool intact = state.receivedHash == state.hash;
+    deadline.arm();
+    co_await writeU64(socket, intact);
+    if (!intact) {
+        std::cerr << "Content hash mismatch, discarding transfer.\n";
+        state.resumable = false;
+    }
+    co_return intact;
+}
+
+static void reportProgress(TransferStatus& status, uint64_t ackedChunks, const ProgressCallback& onProgress) {
+    status.ackedBytes = std::min<uint64_t>(ackedChunks * detail::CHUNK_BYTES, status.totalBytes);
+    if (onProgress) onProgress(status);
+}
+
+// Sender side of one connection, true once the receiver confirmed the payload
+static asio::awaitable<bool> sendOn(tcp::socket& socket, Deadline& deadline, const ByteVector& data, uint64_t hash,
+    TransferStatus& status, const ProgressCallback& onProgress) {
+    using namespace detail;
 
-        uint32_t len_net;
-        asio::read(socket, asio::buffer(&len_net, sizeof(len_net)));
-        uint32_t len = ntohl(len_net);
+    const uint64_t chunkCount = (data.size() + CHUNK_BYTES - 1) / CHUNK_BYTES;
+    deadline.arm();
+    co_await writeU64(socket, hash);
+    co_await writeU64(socket, data.size());
+    co_await writeU64(socket, CHUNK_BYTES);
 
-        ByteVector data(len);
-        asio::read(socket, asio::buffer(data.data(), len));
-        return data;
+    uint64_t acked = co_await readU64(socket);
+    if (acked > chunkCount) throw std::runtime_error("Receiver acknowledged unknown chunks");
+    if (acked > 0) std::cout << "Resuming at chunk " << acked << " of " << chunkCount << '\n';
+    reportProgress(status, acked, onProgress);
+
+    uint64_t next = acked;
+    while (acked < chunkCount) {
+        deadline.arm();
+        if (next < chunkCount && next - acked < ACK_WINDOW) {
+            size_t offset = next * CHUNK_BYTES;
+            size_t size = std::min<size_t>(CHUNK_BYTES, data.size() - offset);
+            co_await asio::async_write(socket, asio::buffer(data.data() + offset, size), asio::use_awaitable);
+            next++;
+            continue;
+        }
+        uint64_t ack = co_await readU64(socket);
+        if (ack != acked + 1) throw std::runtime_error("Unexpected chunk acknowledgement");
+        acked = ack;
+        reportProgress(status, acked, onProgress);
+    }
+
+    deadline.arm();
+    if (co_await readU64(socket) == 1) co_return true;
+    status.lastError = "Receiver rejected content hash";
+    std::cerr << "Receiver rejected content hash, resending.\n";
+    co_return false;
+}
+
+// Turns away connections that do not come from IP, or that were reset before they could be checked
+static bool acceptedFrom(tcp::socket& socket, const std::string& IP) {
+    asio::error_code ec;
+    const tcp::endpoint remote = socket.remote_endpoint(ec);
+    if (ec) {
+        std::cerr << "Connection dropped on accept: " << ec.message() << '\n';
+        return false;
+    }
+    if (remote.address() != asio::ip::make_address(IP)) {
+        std::cerr << "Connection from unauthorized IP: " << remote.address() << '\n';
+        return false;
+    }
+    socket.set_option(asio::socket_base::keep_alive(true), ec);
+    if (ec) {
+        std::cerr << "Connection dropped on accept: " << ec.message() << '\n';
+        return false;
+    }
+    std::cout << "Client connected from " << remote << '\n';
+    return true;
+}
+
+// Accepts one connection, a failed accept only costs the attempt it was made for
+static asio::awaitable<bool> acceptFrom(tcp::acceptor& acceptor, tcp::socket& socket, const std::string& IP) {
+    asio::error_code ec;
+    co_await acceptor.async_accept(socket, asio::redirect_error(asio::use_awaitable, ec)); // wait for client to connect
+    if (ec) {
+        std::cerr << "Accept failed: " << ec.message() << '\n';
+        co_return false;
+    }
+    co_return acceptedFrom(socket, IP);
+}
+
+// Waits before every attempt but the first, longer each time
+static asio::awaitable<void> backOff(int attempt) {
+    if (attempt == 0) co_return;
+    asio::steady_timer backoff(co_await asio::this_coro::executor, std::chrono::milliseconds(100 << attempt));
+    co_await backoff.async_wait(asio::use_awaitable);
+}
+
+static asio::awaitable<void> connectTo(tcp::socket& socket, Deadline& deadline, const std::string& IP, uint32_t port) {
+    tcp::resolver resolver(socket.get_executor());
+    tcp::resolver::results_type endpoints = co_await resolver.async_resolve(IP, std::to_string(port), asio::use_awaitable);
+
+    deadline.arm();
+    co_await asio::async_connect(socket, endpoints, asio::use_awaitable);
+    socket.set_option(asio::socket_base::keep_alive(true));
+}
+
+// Binds `port` on the awaiting executor, before the transfer moves to its strand, so a
+// receiver listens from the moment it starts
+static std::optional<tcp::acceptor> listenOn(const asio::any_io_executor& executor, uint32_t port) {
+    try {
+        tcp::acceptor acceptor(executor, tcp::endpoint(tcp::v4(), port));
+        std::cout << "Server listening on port " << port << "...\n";
+        return acceptor;
     }
     catch (std::exception& e) {
         std::cerr << e.what() << '\n';
+        return std::nullopt;
     }
-    return {};
 }
 
-void sendData(std::string IP, uint32_t port, ByteVector data) {
-    if (data.size() <= 0) return;
+static asio::awaitable<ByteVector> getDataOnStrand(tcp::acceptor acceptor, std::string IP) {
+    using namespace detail;
+
+    ReceiveState state;
     try {
-        asio::io_context io;
+        auto executor = co_await asio::this_coro::executor;
+
+        // Stray connections and ones failing the handshake do not use up an attempt
+        while (state.attempts < MAX_ATTEMPTS) {
+            tcp::socket socket(executor);
+            if (!(co_await acceptFrom(acceptor, socket, IP))) continue;
+            Deadline deadline(socket);
+
+            try {
+                if (co_await receiveOn(socket, deadline, state)) co_return std::move(state.data);
+            }
+            catch (std::exception& e) {
+                std::cerr << (deadline.expired() ? "Timed out" : e.what()) << " (holding " << state.chunksReceived << " chunks)\n";
+            }
+        }
+    }
+    catch (std::exception& e) {
+        std::cerr << e.what() << '\n';
+    }
+    co_return ByteVector{};
+}
 
-        tcp::resolver resolver(io);
-        tcp::resolver::results_type endpoints = resolver.resolve(IP, std::to_string(port));
+static asio::awaitable<bool> sendDataOnStrand(std::string IP, uint32_t port, const ByteVector& data, uint64_t hash, TransferStatus& status,
+    ProgressCallback onProgress) {
+    using namespace detail;
 
-        tcp::socket socket(io);
-        asio::connect(socket, endpoints);
+    status.totalBytes = data.size();
+    if (data.size() <= 0) {
+        status.lastError = "Nothing to send";
+        co_return false;
+    }
+    if (data.size() > MAX_PAYLOAD_BYTES) {
+        status.lastError = "Payload exceeds the limit";
+        co_return false;
+    }
+    auto executor = co_await asio::this_coro::executor;
 
-        uint32_t len = htonl(data.size());   // network byte order
-        asio::write(socket, asio::buffer(&len, sizeof(len)));
-        asio::write(socket, asio::buffer(data));
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++) {
+        co_await backOff(attempt);
+        status.attempts = attempt + 1;
+        tcp::socket socket(executor);
+        Deadline deadline(socket);
+        try {
+            co_await connectTo(socket, deadline, IP, port);
+            if (co_await sendOn(socket, deadline, data, hash, status, onProgress)) {
+                std::cout << "Data sent.\n";
+                status.delivered = true;
+                status.lastError.clear();
+                if (onProgress) onProgress(status);
+                co_return true;
+            }
+        }
+        catch (std::exception& e) {
+            status.lastError = deadline.expired() ? "Timed out" : e.what();
+            std::cerr << status.lastError << '\n';
+        }
+    }
+    if (onProgress) onProgress(status);
+    co_return false;
+}
+
+// Runs respond(request) and hashes the reply on `workers`, keeping the client's deadline alive
+// meanwhile. False if the client went away, the reply is complete either way. Called on the
+// transfer's strand, which the keepalives and the completion share with the socket's Deadline.
+static asio::awaitable<bool> respondOn(tcp::socket& socket, Deadline& deadline, asio::thread_pool& workers,
+    const std::function<ByteVector(const ByteVector&)>& respond, const ByteVector& request, ByteVector& reply, uint64_t& replyHash) {
+    using namespace detail;
 
-        std::cout << "Data sent.\n";
+    auto strand = co_await asio::this_coro::executor;
+    // Woken by cancelling the timer once the worker is done
+    asio::steady_timer tick(strand);
+    bool connected = true;
+    bool done = false;
+    std::exception_ptr failure;
+    asio::co_spawn(workers, [&]() -> asio::awaitable<void> {
+        reply = respond(request);
+        replyHash = contentHash(reply.data(), reply.size());
+        co_return;
+    }, asio::bind_executor(strand, [&](std::exception_ptr e) {
+        failure = e;
+        done = true;
+        tick.cancel();
+    }));
+    // The worker refers to this frame, so it is awaited even when the client is gone
+    while (!done) {
+        tick.expires_after(KEEPALIVE_INTERVAL);
+        asio::error_code cancelled;
+        co_await tick.async_wait(asio::redirect_error(asio::use_awaitable, cancelled));
+        if (done || !connected) continue;
+        try {
+            deadline.arm();
+            co_await writeU64(socket, REPLY_PENDING);
+        }
+        catch (std::exception&) {
+            connected = false;
+        }
+    }
+    if (failure) std::rethrow_exception(failure);
+    co_return connected;
+}
+
+static asio::awaitable<ByteVector> requestDataOnStrand(std::string IP, uint32_t port, const ByteVector& request) {
+    using namespace detail;
+
+    const uint64_t hash = contentHash(request.data(), request.size());
+    TransferStatus status;
+    status.totalBytes = request.size();
+    ReceiveState reply;
+    auto executor = co_await asio::this_coro::executor;
+
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++) {
+        co_await backOff(attempt);
+        tcp::socket socket(executor);
+        Deadline deadline(socket);
+        try {
+            co_await connectTo(socket, deadline, IP, port);
+            if (!(co_await sendOn(socket, deadline, request, hash, status, {}))) continue;
+            for (;;) {
+                deadline.arm();
+                const uint64_t state = co_await readU64(socket);
+                if (state == REPLY_READY) break;
+                if (state != REPLY_PENDING) throw std::runtime_error("Unexpected reply state");
+            }
+            if (co_await receiveOn(socket, deadline, reply)) co_return std::move(reply.data);
+        }
+        catch (std::exception& e) {
+            std::cerr << (deadline.expired() ? "Timed out" : e.what()) << '\n';
+        }
+    }
+    co_return ByteVector{};
+}
+
+static asio::awaitable<bool> serveDataOnStrand(tcp::acceptor acceptor, std::string IP, asio::thread_pool& workers, std::function<ByteVector(const ByteVector&)> respond) {
+    using namespace detail;
+
+    ReceiveState request;
+    ByteVector reply;
+    uint64_t replyHash = 0;
+    bool answered = false;
+    uint64_t answeredHash = 0; // request the reply belongs to, a reconnect repeats it
+    TransferStatus status;
+    try {
+        auto executor = co_await asio::this_coro::executor;
+
+        // Only connections that got through the request's handshake use up an attempt
+        while (request.attempts < MAX_ATTEMPTS) {
+            tcp::socket socket(executor);
+            if (!(co_await acceptFrom(acceptor, socket, IP))) continue;
+            Deadline deadline(socket);
+
+            try {
+                if (!(co_await receiveOn(socket, deadline, request))) continue;
+                if (!answered || answeredHash != request.hash) {
+                    answered = false;
+                    const bool connected = co_await respondOn(socket, deadline, workers, respond, request.data, reply, replyHash);
+                    answeredHash = request.hash;
+                    answered = true;
+                    if (!connected) throw std::runtime_error("Client left while the reply was prepared");
+                }
+                deadline.arm();
+                co_await writeU64(socket, REPLY_READY);
+                status.totalBytes = reply.size();
+                if (co_await sendOn(socket, deadline, reply, replyHash, status, {})) co_return true;
+            }
+            catch (std::exception& e) {
+                std::cerr << (deadline.expired() ? "Timed out" : e.what()) << '\n';
+            }
+        }
     }
     catch (std::exception& e) {
         std::cerr << e.what() << '\n';
     }
+    co_return false;
+}
+
+asio::awaitable<ByteVector> asyncGetData(std::string IP, uint32_t port) {
+    std::optional<tcp::acceptor> acceptor = listenOn(co_await asio::this_coro::executor, port);
+    if (!acceptor) co_return ByteVector{};
+    co_return co_await onStrand(getDataOnStrand(std::move(*acceptor), std::move(IP)));
+}
+
+asio::awaitable<bool> asyncSendData(std::string IP, uint32_t port, const ByteVector& data) {
+    TransferStatus status;
+    co_return co_await asyncSendData(IP, port, data, status);
+}
+
+asio::awaitable<bool> asyncSendData(std::string IP, uint32_t port, const ByteVector& data, TransferStatus& status,
+    ProgressCallback onProgress) {
+    co_return co_await asyncSendData(IP, port, data, contentHash(data.data(), data.size()), status, std::move(onProgress));
+}
+
+asio::awaitable<bool> asyncSendData(std::string IP, uint32_t port, const ByteVector& data, uint64_t hash, TransferStatus& status,
+    ProgressCallback onProgress) {
+    co_return co_await onStrand(sendDataOnStrand(std::move(IP), port, data, hash, status, std::move(onProgress)));
+}
+
+asio::awaitable<ByteVector> asyncRequestData(std::string IP, uint32_t port, const ByteVector& request) {
+    co_return co_await onStrand(requestDataOnStrand(std::move(IP), port, request));
+}
+
+asio::awaitable<bool> asyncServeData(std::string IP, uint32_t port, asio::thread_pool& workers, std::function<ByteVector(const ByteVector&)> respond) {
+    std::optional<tcp::acceptor> acceptor = listenOn(co_await asio::this_coro::executor, port);
+    if (!acceptor) co_return false;
+    co_return co_await onStrand(serveDataOnStrand(std::move(*acceptor), std::move(IP), workers, std::move(respond)));
+}
+
+asio::awaitable<std::vector<TransferStatus>> asyncSendDataToAll(std::vector<Endpoint> destinations, const ByteVector& data,
+    std::function<void(size_t destination, const TransferStatus&)> onProgress) {
+    const uint64_t hash = contentHash(data.data(), data.size());
+    co_return co_await asyncSendDataToAll(std::move(destinations), data, hash, std::move(onProgress));
+}
+
+asio::awaitable<std::vector<TransferStatus>> asyncSendDataToAll(std::vector<Endpoint> destinations, const ByteVector& data, uint64_t hash,
+    std::function<void(size_t destination, const TransferStatus&)> onProgress) {
+    std::vector<TransferStatus> statuses(destinations.size());
+    if (destinations.empty()) co_return statuses;
+
+    // The sends and their bookkeeping share a strand, so the caller's executor may be multi-threaded
+    auto strand = asio::make_strand(co_await asio::this_coro::executor);
+    co_await asio::co_spawn(strand, [&]() -> asio::awaitable<void> {
+        // Woken by cancelling the timer once the last send completes
+        asio::steady_timer allDone(strand, asio::steady_timer::time_point::max());
+        size_t running = destinations.size();
+        for (size_t i = 0; i < destinations.size(); i++) {
+            // onProgress outlives every send since this coroutine waits for all of them
+            ProgressCallback progress;
+            if (onProgress) progress = [&onProgress, i](const TransferStatus& status) { onProgress(i, status); };
+            asio::co_spawn(strand, asyncSendData(destinations[i].IP, destinations[i].port, data, hash, statuses[i], std::move(progress)),
+                [&](std::exception_ptr, bool) { if (--running == 0) allDone.cancel(); });
+        }
+        asio::error_code cancelled;
+        co_await allDone.async_wait(asio::redirect_error(asio::use_awaitable, cancelled));
+    }, asio::use_awaitable);
+    co_return statuses;
+}
+
+ByteVector getData(std::string IP, uint32_t port) {
+    return runBlocking(asyncGetData(IP, port));
+}
+
+bool sendData(std::string IP, uint32_t port, const ByteVector& data) {
+    return runBlocking(asyncSendData(IP, port, data));
+}
+
+ByteVector requestData(std::string IP, uint32_t port, const ByteVector& request) {
+    return runBlocking(asyncRequestData(IP, port, request));
+}
+
+bool serveData(std::string IP, uint32_t port, std::function<ByteVector(const ByteVector&)> respond) {
+    asio::thread_pool worker(1);
+    return runBlocking(asyncServeData(IP, port, worker, std::move(respond)));
+}
+
+std::vector<TransferStatus> sendDataToAll(const std::vector<Endpoint>& destinations, const ByteVector& data,
+    std::function<void(size_t destination, const TransferStatus&)> onProgress) {
+    return runBlocking(asyncSendDataToAll(destinations, data, std::move(onProgress)));
 }
@@ -1,10 +1,75 @@
 #pragma once
 #define ASIO_STANDALONE
 #include <asio.hpp>
+#include <chrono>
+#include <functional>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "BaseTypes.h"
 
+namespace detail {
+    constexpr size_t CHUNK_BYTES = 1 << 16;
+    constexpr size_t ACK_WINDOW = 16;
+    constexpr int MAX_ATTEMPTS = 5;
+    // A connect, read or write that makes no progress for this long fails the attempt
+    constexpr std::chrono::seconds IO_TIMEOUT{ 30 };
+    // Largest payload a receiver allocates for
+    constexpr uint64_t MAX_PAYLOAD_BYTES = uint64_t(1) << 34;
+    // A server preparing a reply tells the waiting client so this often
+    constexpr std::chrono::seconds KEEPALIVE_INTERVAL = IO_TIMEOUT / 3;
+    constexpr uint64_t REPLY_PENDING = 0;
+    constexpr uint64_t REPLY_READY = 1;
+    // contentHash of nothing, the state a running hash starts from
+    constexpr uint64_t CONTENT_HASH_SEED = 0xcbf2'9ce4'8422'2325;
+}
+
+struct Endpoint {
+    std::string IP;
+    uint32_t port = 0;
+};
+
+// State of one send, updated while it runs
+struct TransferStatus {
+    uint64_t ackedBytes = 0;
+    uint64_t totalBytes = 0;
+    int attempts = 0;
+    bool delivered = false;
+    std::string lastError;
+};
+
+// Called after every acknowledged chunk and when the send ends
+using ProgressCallback = std::function<void(const TransferStatus&)>;
+
+// Continues `hash` over the bytes, so a payload can be hashed piece by piece in order
+uint64_t contentHash(const uint8_t* data, size_t bytes, uint64_t hash = detail::CONTENT_HASH_SEED);
+
 ByteVector getData(std::string IP, uint32_t port);
-void sendData(std::string IP, uint32_t port, ByteVector data);
\ No newline at end of file
+bool sendData(std::string IP, uint32_t port, const ByteVector& data);
+// One request and its reply over a single connection, the reply is empty on failure
+ByteVector requestData(std::string IP, uint32_t port, const ByteVector& request);
+bool serveData(std::string IP, uint32_t port, std::function<ByteVector(const ByteVector&)> respond);
+// Sends `data` to every destination at once, one status per destination
+std::vector<TransferStatus> sendDataToAll(const std::vector<Endpoint>& destinations, const ByteVector& data,
+    std::function<void(size_t destination, const TransferStatus&)> onProgress = {});
+
+// Coroutine versions. Each runs its sockets and timers on its own strand of
+// the awaiting executor, so that executor may be multi-threaded.
+asio::awaitable<ByteVector> asyncGetData(std::string IP, uint32_t port);
+// `data` must stay alive until the returned awaitable completes
+asio::awaitable<bool> asyncSendData(std::string IP, uint32_t port, const ByteVector& data);
+asio::awaitable<bool> asyncSendData(std::string IP, uint32_t port, const ByteVector& data, TransferStatus& status,
+    ProgressCallback onProgress = {});
+// Same, for a payload whose contentHash the caller already has
+asio::awaitable<bool> asyncSendData(std::string IP, uint32_t port, const ByteVector& data, uint64_t hash, TransferStatus& status,
+    ProgressCallback onProgress = {});
+// Likewise `request`
+asio::awaitable<ByteVector> asyncRequestData(std::string IP, uint32_t port, const ByteVector& request);
+// respond runs on `workers`, the caller's executor only waits for it
+asio::awaitable<bool> asyncServeData(std::string IP, uint32_t port, asio::thread_pool& workers, std::function<ByteVector(const ByteVector&)> respond);
+// Same lifetime rule for `data`, shared by every destination
+asio::awaitable<std::vector<TransferStatus>> asyncSendDataToAll(std::vector<Endpoint> destinations, const ByteVector& data,
+    std::function<void(size_t destination, const TransferStatus&)> onProgress = {});
+asio::awaitable<std::vector<TransferStatus>> asyncSendDataToAll(std::vector<Endpoint> destinations, const ByteVector& data, uint64_t hash,
+    std::function<void(size_t destination, const TransferStatus&)> onProgress = {});
@@ -0,0 +1,170 @@
+#include "PackedBoard.h"
+#include "BoardConverter.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define PACKED_BOARD_SSE2
+#include <emmintrin.h>
+#endif
+
+static_assert(sizeof(Board) == 9, "packBoards reads boards as 9 consecutive bytes");
+
+namespace {
+	// Row codes indexed by (x mask of the row) | (o mask of the row) << 3, and
+	// the row masks of every 5-bit row code, both taken from the BoardConverter
+	// functions so the two representations can never disagree.
+	struct RowTables {
+		uint8_t code[64] = {};
+		uint8_t xBits[32] = {};
+		uint8_t oBits[32] = {};
+	};
+
+	const RowTables& rowTables() {
+		static const RowTables tables = [] {
+			RowTables t;
+			for (uint8_t x = 0; x < 8; x++) {
+				for (uint8_t o = 0; o < 8; o++) {
+					if (x & o) continue;
+					Square row[3];
+					for (int c = 0; c < 3; c++) {
+						row[c] = (x >> c & 1) ? Square::X : (o >> c & 1) ? Square::O : Square::none;
+					}
+					t.code[x | o << 3] = rowToFiveBit(row);
+				}
+			}
+			for (uint8_t bits = 0; bits < 32; bits++) {
+				Square row[3];
+				fiveBitsToRow(bits, row);
+				for (int c = 0; c < 3; c++) {
+					t.xBits[bits] |= (row[c] == Square::X) << c;
+					t.oBits[bits] |= (row[c] == Square::O) << c;
+				}
+			}
+			return t;
+		}();
+		return tables;
+	}
+
+	uint16_t tableFifteenBit(const RowTables& tables, PackedBoard packed) {
+		const uint16_t x = packed.xMask();
+		const uint16_t o = packed.oMask();
+		return uint16_t(tables.code[(x & 0b111) | (o & 0b111) << 3])
+			| uint16_t(tables.code[(x >> 3 & 0b111) | (o >> 3 & 0b111) << 3]) << 5
+			| uint16_t(tables.code[(x >> 6 & 0b111) | (o >> 6 & 0b111) << 3]) << 10;
+	}
+
+	uint8_t scalarWinners(PackedBoard packed) {
+		return (packedIsWinner(packed, Square::X) ? detail::X_WINS : 0)
+			| (packedIsWinner(packed, Square::O) ? detail::O_WINS : 0);
+	}
+
+#ifdef PACKED_BOARD_SSE2
+	// Low byte of each 32-bit lane, lanes hold values <= 255
+	void storeLaneBytes(__m128i lanes, uint8_t* out) {
+		__m128i words = _mm_packs_epi32(lanes, lanes);
+		__m128i bytes = _mm_packus_epi16(words, words);
+		int packed = _mm_cvtsi128_si32(bytes);
+		std::memcpy(out, &packed, 4);
+	}
+#endif
+}
+
+PackedBoard packBoard(const Board& board) {
+	const Square* squares = &board.squares[0][0];
+	uint32_t bits = 0;
+	for (int i = 0; i < 9; i++) {
+		bits |= uint32_t(squares[i] == Square::X) << i;
+		bits |= uint32_t(squares[i] == Square::O) << (16 + i);
+	}
+	return { bits };
+}
+
+Board unpackBoard(PackedBoard packed) {
+	Board board;
+	Square* squares = &board.squares[0][0];
+	for (int i = 0; i < 9; i++) {
+		squares[i] = (packed.bits >> i & 1) ? Square::X : (packed.bits >> (16 + i) & 1) ? Square::O : Square::none;
+	}
+	return board;
+}
+
+uint16_t packedToFifteenBit(PackedBoard packed) {
+	return tableFifteenBit(rowTables(), packed);
+}
+
+PackedBoard fifteenBitToPacked(uint16_t bits) {
+	const RowTables& tables = rowTables();
+	uint32_t x = 0;
+	uint32_t o = 0;
+	for (int r = 0; r < 3; r++) {
+		const uint8_t row = (bits >> 5 * r) & 0b11111;
+		x |= uint32_t(tables.xBits[row]) << 3 * r;
+		o |= uint32_t(tables.oBits[row]) << 3 * r;
+	}
+	return { x | o << 16 };
+}
+
+void packBoards(const Board* boards, size_t count, PackedBoard* out) {
+	size_t i = 0;
+#ifdef PACKED_BOARD_SSE2
+	// A 16 byte load from board i stays inside the array for all but the last board
+	const __m128i xs = _mm_set1_epi8(char(Square::X));
+	const __m128i os = _mm_set1_epi8(char(Square::O));
+	for (; i + 1 < count; i++) {
+		__m128i squares = _mm_loadu_si128(reinterpret_cast<const __m128i*>(boards + i));
+		uint32_t x = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(squares, xs))) & 0x1FF;
+		uint32_t o = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(squares, os))) & 0x1FF;
+		out[i].bits = x | o << 16;
+	}
+#endif
+	for (; i < count; i++) out[i] = packBoard(boards[i]);
+}
+
+void packedToFifteenBits(const PackedBoard* boards, size_t count, uint16_t* out) {
+	// Three table lookups per board, which SSE2 has no gather for
+	const RowTables& tables = rowTables();
+	for (size_t i = 0; i < count; i++) out[i] = tableFifteenBit(tables, boards[i]);
+}
+
+void countMarks(const PackedBoard* boards, size_t count, uint8_t* out) {
+	size_t i = 0;
+#ifdef PACKED_BOARD_SSE2
+	// SWAR popcount on four 32-bit lanes
+	const __m128i m1 = _mm_set1_epi32(0x5555'5555);
+	const __m128i m2 = _mm_set1_epi32(0x3333'3333);
+	const __m128i m4 = _mm_set1_epi32(0x0F0F'0F0F);
+	for (; i + 4 <= count; i += 4) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(boards + i));
+		v = _mm_sub_epi32(v, _mm_and_si128(_mm_srli_epi32(v, 1), m1));
+		v = _mm_add_epi32(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi32(v, 2), m2));
+		v = _mm_and_si128(_mm_add_epi32(v, _mm_srli_epi32(v, 4)), m4);
+		v = _mm_add_epi32(v, _mm_srli_epi32(v, 8));
+		v = _mm_add_epi32(v, _mm_srli_epi32(v, 16));
+		storeLaneBytes(_mm_and_si128(v, _mm_set1_epi32(0x3F)), out + i);
+	}
+#endif
+	for (; i < count; i++) out[i] = packedMarks(boards[i]);
+}
+
+void detectWinners(const PackedBoard* boards, size_t count, uint8_t* out) {
+	size_t i = 0;
+#ifdef PACKED_BOARD_SSE2
+	for (; i + 4 <= count; i += 4) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(boards + i));
+		__m128i xWins = _mm_setzero_si128();
+		__m128i oWins = _mm_setzero_si128();
+		for (uint16_t line : detail::WIN_LINES) {
+			const __m128i xLine = _mm_set1_epi32(line);
+			const __m128i oLine = _mm_set1_epi32(int(uint32_t(line) << 16));
+			xWins = _mm_or_si128(xWins, _mm_cmpeq_epi32(_mm_and_si128(v, xLine), xLine));
+			oWins = _mm_or_si128(oWins, _mm_cmpeq_epi32(_mm_and_si128(v, oLine), oLine));
+		}
+		__m128i flags = _mm_or_si128(
+			_mm_and_si128(xWins, _mm_set1_epi32(detail::X_WINS)),
+			_mm_and_si128(oWins, _mm_set1_epi32(detail::O_WINS)));
+		storeLaneBytes(flags, out + i);
+	}
+#endif
+	for (; i < count; i++) out[i] = scalarWinners(boards[i]);
+}
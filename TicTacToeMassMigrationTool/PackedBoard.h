@@ -0,0 +1,81 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+#include "BaseTypes.h"
+
+/* ---------------------------------------------------------------------------
+ *  Bitboard representation of a Board
+ *
+ *  +-----------------------------------------------+
+ *  | Bit-layout of PackedBoard::bits (LSB first)   |
+ *  +------+----------------------------------------+
+ *  |  0-8 | X MASK - bit (row * 3 + column) set    |
+ *  |      |          when that square is X         |
+ *  | 9-15 | always zero                            |
+ *  |16-24 | O MASK - same indexing for O           |
+ *  |25-31 | always zero                            |
+ *  +------+----------------------------------------+
+ *
+ *  packBoard / unpackBoard convert losslessly to and from Board.
+ *  packedToFifteenBit / fifteenBitToPacked are table driven equivalents of
+ *  boardToFifteenBit / fifteenBitToBoard (row codes from rowToFiveBit).
+ *
+ *  Batch kernels
+ *  -------------
+ *    packBoards           Board[]       -> PackedBoard[]
+ *    packedToFifteenBits  PackedBoard[] -> 15-bit codes
+ *    countMarks           PackedBoard[] -> number of marks per board
+ *    detectWinners        PackedBoard[] -> X_WINS | O_WINS per board
+ *
+ *  On x86-64 the kernels use SSE2 (part of the base ISA, so no runtime
+ *  dispatch is needed): packBoards compares 16 bytes of a board at a time
+ *  and collects the X and O masks with movemask, countMarks and
+ *  detectWinners work on 4 boards per register. Every other target, and the
+ *  tail of every batch, takes the scalar path. packedToFifteenBits is scalar
+ *  everywhere: it is three row table lookups per board, fetching the tables
+ *  once per batch.
+ * ------------------------------------------------------------------------- */
+
+struct PackedBoard {
+	uint32_t bits = 0;
+
+	uint16_t xMask() const { return bits & 0x1FF; }
+	uint16_t oMask() const { return (bits >> 16) & 0x1FF; }
+};
+
+namespace detail {
+	// The winning lines as 9-bit square masks
+	constexpr uint16_t WIN_LINES[8] = {
+		0b000'000'111, 0b000'111'000, 0b111'000'000,	// rows
+		0b001'001'001, 0b010'010'010, 0b100'100'100,	// columns
+		0b100'010'001, 0b001'010'100					// diagonals
+	};
+
+	constexpr uint8_t X_WINS = 1 << 0;
+	constexpr uint8_t O_WINS = 1 << 1;
+}
+
+PackedBoard packBoard(const Board& board);
+Board unpackBoard(PackedBoard packed);
+
+uint16_t packedToFifteenBit(PackedBoard packed);
+PackedBoard fifteenBitToPacked(uint16_t bits);
+
+inline uint8_t packedMarks(PackedBoard packed) {
+	return uint8_t(std::popcount(packed.bits));
+}
+
+inline bool packedIsWinner(PackedBoard packed, Square player) {
+	const uint16_t mask = player == Square::X ? packed.xMask() : packed.oMask();
+	for (uint16_t line : detail::WIN_LINES) {
+		if ((mask & line) == line) return true;
+	}
+	return false;
+}
+
+void packBoards(const Board* boards, size_t count, PackedBoard* out);
+void packedToFifteenBits(const PackedBoard* boards, size_t count, uint16_t* out);
+void countMarks(const PackedBoard* boards, size_t count, uint8_t* out);
+void detectWinners(const PackedBoard* boards, size_t count, uint8_t* out);
@@ -1,38 +1,973 @@
 #include "TicTacToeMassMigrationTool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
 
-void streamOutBoards(const BoardStream& boards, std::string IP, size_t port) {
-	ByteVector memory = boardsToMemoryBlock(boards);
-	HuffmanTree tree(memory);
-	ByteVector treeMemory = tree.getHuffmanTree();
-	tree.serialize(memory);
-	ByteVector outData;
-
-	//Header
-	outData.insert(outData.begin(), {
-			uint8_t(treeMemory.size() >> 8 * 0), uint8_t(treeMemory.size() >> 8 * 1), uint8_t(treeMemory.size() >> 8 * 2), uint8_t(treeMemory.size() >> 8 * 3), uint8_t(treeMemory.size() >> 8 * 4), uint8_t(treeMemory.size() >> 8 * 5), uint8_t(treeMemory.size() >> 8 * 6), uint8_t(treeMemory.size() >> 8 * 7),
-			uint8_t(memory.size() >> 8 * 0), uint8_t(memory.size() >> 8 * 1), uint8_t(memory.size() >> 8 * 2), uint8_t(memory.size() >> 8 * 3), uint8_t(memory.size() >> 8 * 4), uint8_t(memory.size() >> 8 * 5), uint8_t(memory.size() >> 8 * 6), uint8_t(memory.size() >> 8 * 7),
-			uint8_t(boards.size() >> 8 * 0), uint8_t(boards.size() >> 8 * 1), uint8_t(boards.size() >> 8 * 2), uint8_t(boards.size() >> 8 * 3), uint8_t(boards.size() >> 8 * 4), uint8_t(boards.size() >> 8 * 5), uint8_t(boards.size() >> 8 * 6), uint8_t(boards.size() >> 8 * 7)
+/* ---------------------------------------------------------------------------
+ *  Frame layout (all fields 64-bit little-endian)
+ *
+ *      [0..8)    format          : byte 0 is the CompressionLevel used,
+ *                                  byte 1 holds the FLAG_* bits,
+ *                                  bytes 2..3 FRAME_VERSION,
+ *                                  bytes 4..7 FRAME_MAGIC
+ *      [8..16)   treeBytes       : size of the serialized Huffman tree (0 for raw)
+ *      [16..24)  memBytes        : size of the coded boards
+ *      [24..32)  boards          : number of boards in the stream
+ *      [32..40)  transformBytes  : size of the symmetry section (0 without FLAG_SYMMETRY)
+ *      [40..48)  codedBoards     : number of coded boards (== boards without FLAG_DEDUP)
+ *      [48..56)  dedupBytes      : size of the game table (0 without FLAG_DEDUP)
+ *      [56..64)  checksumBytes   : size of the checksum section (0 without FLAG_CHECKSUM)
+ *      [64..72)  summaryBytes    : size of the summary section (0 without FLAG_SUMMARY)
+ *      tree, coded boards, symmetry section, game table, summary section,
+ *      checksum section
+ *
+ *  The decoder rejects a frame whose magic or version differs, whose section
+ *  sizes (added with overflow checks) do not sum to the frame size, or that
+ *  claims more than MAX_BOARDS_PER_BYTE boards per frame byte, all before it
+ *  allocates anything. The encoder adds checksums to a frame that would
+ *  otherwise be denser than that, since their section alone bounds it.
+ *
+ *  Codecs
+ *  ------
+ *    raw      : the 15-bit codes packed back to back, see boardsToMemoryBlock.
+ *    huffman  : the 15-bit codes Huffman coded, see HuffmanTree.
+ *
+ *  encodeBoards works in (at most) two passes over the BoardStream:
+ *    1. every board is converted to its 15-bit code and counted,
+ *    2. the code is recomputed and written straight into the frame behind
+ *       the tree, either Huffman coded or as is.
+ *  The exact payload size is known after pass 1 so the frame is allocated
+ *  once and no packed 15-bit copy of the stream is ever materialized. The raw
+ *  codec needs no counts and skips pass 1.
+ *
+ *  Games
+ *  -----
+ *    The per game stages below split the stream with startsGame(), which
+ *    depends neither on orientation nor on position in the stream, so the
+ *    decoder finds the same boundaries in the decoded boards. The first board
+ *    of the stream always starts a game. Their decisions are collected in a
+ *    StreamPlan before any coding happens.
+ *
+ *  Symmetry (FLAG_SYMMETRY)
+ *  ------------------------
+ *    Every game is turned into its canonical orientation (canonicalTransform)
+ *    before coding, so games that are rotations or mirrors of each other
+ *    produce the same codes. The transform id of each game is stored in the
+ *    symmetry section, 3 bits per game in stream order, and the decoder
+ *    applies the inverse.
+ *
+ *  Deduplication (FLAG_DEDUP)
+ *  --------------------------
+ *    Games are looked up in a GameDictionary (after canonicalization when
+ *    FLAG_SYMMETRY is set). Only the first occurrence of a game is coded.
+ *    The game table has one entry per game in stream order:
+ *        0                 : the next coded game
+ *        1, id (idBits)    : a repeat of distinct game `id`
+ *    where ids count the coded games in order and idBits is the number of
+ *    bits needed for the largest id.
+ *
+ *  Checksums (FLAG_CHECKSUM)
+ *  -------------------------
+ *    The checksum section holds 32-bit little-endian crc32c values of
+ *      -> every CHECK_BLOCK_BYTES block of the frame in front of it (header
+ *         included), then
+ *      -> every CHECK_BLOCK_BOARDS block of the decoded BoardStream, taken
+ *         over the Board bytes.
+ *    The decoder checks the blocks holding the header and the tree before it
+ *    trusts them, verifies the remaining compressed blocks on another thread
+ *    while it decodes, and finally checks the decoded boards block by block.
+ *    Any mismatch rejects the whole frame.
+ *
+ *  Block summaries (FLAG_SUMMARY)
+ *  ------------------------------
+ *    The summary section lists the distinct boards of the stream once and
+ *    then describes every SUMMARY_BLOCK_BOARDS decoded boards, little-endian:
+ *      [0..8)    positions P   : number of distinct board codes
+ *      P x u16                 : the codes, ascending, zero padded to 8 bytes
+ *      per block, SUMMARY_BYTES then the block's positions:
+ *        [0..8)    codeBitOffset : bit offset of the block's first code in
+ *                                  the coded boards (0 with FLAG_DEDUP, where
+ *                                  coded and decoded boards do not line up)
+ *        [8..16)   gameIndex     : game holding the block's first board
+ *        [16..28)  games, xWins, oWins of the games starting in the block
+ *        [28..64)  gameLengths   : 9 x u32
+ *        [64..72)  n             : number of distinct codes in the block
+ *        either n x u16 ids of those codes, ascending, zero padded to 8
+ *        bytes, if that is smaller than the bitmap, or
+ *        ceil(P / 64) x u64 bitmap, bit i set if code i occurs in the block
+ *    A block therefore costs 72 bytes plus min(2n, P / 8) bytes, rounded up
+ *    to 8. On simulated games that is 1-6% of the frame. Uniformly random
+ *    boards put about a third of all positions in every block, where the
+ *    bitmap is close to the least any exact set can take, and the summaries
+ *    add about 19%.
+ *    Statistics are sums over the blocks. Position queries skip blocks that
+ *    do not hold the board and walk the codes of the others from
+ *    codeBitOffset, taking the game transforms from the symmetry section at
+ *    3 * gameIndex bits; boards are only built for blocks that are selected.
+ *    With FLAG_CHECKSUM the queries first check the checksum blocks covering
+ *    the header, the tree, the symmetry and summary sections and the codes
+ *    of every block they walk.
+ *
+ *  Automatic selection
+ *  -------------------
+ *    The codes are counted and the Shannon entropy is estimated (with the
+ *    Miller-Madow correction for symbols a sample missed). Without per game
+ *    stages only up to SAMPLE_BOARDS evenly spaced boards are counted; with
+ *    them every coded board is, and the counts are reused for the tree. The
+ *    Huffman size is predicted as entropy bits per board plus ~17 bits per
+ *    distinct board for the tree. Codecs are tried cheapest first and the
+ *    first whose predicted size is at most targetRatio of the raw size is
+ *    used; if none qualifies the extra work is not worth it and raw is used.
+ * ------------------------------------------------------------------------- */
+
+struct FrameHeader {
+	CompressionLevel codec = CompressionLevel::raw;
+	uint8_t flags = 0;
+	uint16_t version = detail::FRAME_VERSION;
+	uint32_t magic = detail::FRAME_MAGIC;
+	uint64_t treeBytes = 0;
+	uint64_t memBytes = 0;
+	uint64_t boards = 0;
+	uint64_t transformBytes = 0;
+	uint64_t codedBoards = 0;
+	uint64_t dedupBytes = 0;
+	uint64_t checksumBytes = 0;
+	uint64_t summaryBytes = 0;
+};
+
+static void writeHeader(uint8_t* out, const FrameHeader& header) {
+	putU64(out + 0, uint64_t(header.codec) | uint64_t(header.flags) << 8 | uint64_t(header.version) << 16 | uint64_t(header.magic) << 32);
+	putU64(out + 8, header.treeBytes);
+	putU64(out + 16, header.memBytes);
+	putU64(out + 24, header.boards);
+	putU64(out + 32, header.transformBytes);
+	putU64(out + 40, header.codedBoards);
+	putU64(out + 48, header.dedupBytes);
+	putU64(out + 56, header.checksumBytes);
+	putU64(out + 64, header.summaryBytes);
+}
+
+static FrameHeader readHeader(const uint8_t* in) {
+	FrameHeader header;
+	uint64_t format = getU64(in + 0);
+	header.codec = CompressionLevel(format & 0xFF);
+	header.flags = uint8_t(format >> 8);
+	header.version = uint16_t(format >> 16);
+	header.magic = uint32_t(format >> 32);
+	header.treeBytes = getU64(in + 8);
+	header.memBytes = getU64(in + 16);
+	header.boards = getU64(in + 24);
+	header.transformBytes = getU64(in + 32);
+	header.codedBoards = getU64(in + 40);
+	header.dedupBytes = getU64(in + 48);
+	header.checksumBytes = getU64(in + 56);
+	header.summaryBytes = getU64(in + 64);
+	return header;
+}
+
+// sum += value, false if that overflows
+static bool addChecked(uint64_t& sum, uint64_t value) {
+	if (value > UINT64_MAX - sum) return false;
+	sum += value;
+	return true;
+}
+
+static size_t checksumBytesFor(size_t bodyBytes, size_t boards) {
+	using namespace detail;
+
+	const size_t compressedBlocks = bodyBytes / CHECK_BLOCK_BYTES + (bodyBytes % CHECK_BLOCK_BYTES != 0);
+	const size_t boardBlocks = boards / CHECK_BLOCK_BOARDS + (boards % CHECK_BLOCK_BOARDS != 0);
+	return 4 * (compressedBlocks + boardBlocks);
+}
+
+static uint32_t boardBlockChecksum(const Board* boards, size_t boardCount, size_t block) {
+	using namespace detail;
+
+	const size_t start = block * CHECK_BLOCK_BOARDS;
+	const size_t count = std::min(CHECK_BLOCK_BOARDS, boardCount - start);
+	return crc32c(reinterpret_cast<const uint8_t*>(boards + start), count * sizeof(Board));
+}
+
+// Checks the compressed blocks [first, last) of a frame whose checksum section starts at bodyBytes
+static bool verifyCompressedBlocks(const ByteVector& frame, size_t bodyBytes, size_t first, size_t last) {
+	using namespace detail;
+
+	for (size_t block = first; block < last; block++) {
+		const size_t start = block * CHECK_BLOCK_BYTES;
+		const size_t size = std::min(CHECK_BLOCK_BYTES, bodyBytes - start);
+		if (crc32c(frame.data() + start, size) != getU32(frame.data() + bodyBytes + 4 * block)) return false;
+	}
+	return true;
+}
+
+// Calls fn(start, count) for every game in the stream
+template <typename Fn>
+static void forEachGame(const Board* boards, size_t boardCount, Fn fn) {
+	size_t start = 0;
+	for (size_t i = 1; i <= boardCount; i++) {
+		if (i == boardCount || startsGame(boards[i])) {
+			fn(start, i - start);
+			start = i;
+		}
+	}
+}
+
+bool BlockSummary::contains(const Board& board) const {
+	return std::binary_search(this->positions.begin(), this->positions.end(), boardToFifteenBit(board));
+}
+
+static size_t summaryBlocks(size_t boards) {
+	return (boards + detail::SUMMARY_BLOCK_BOARDS - 1) / detail::SUMMARY_BLOCK_BOARDS;
+}
+
+static size_t pad8(size_t bytes) {
+	return (bytes + 7) & ~size_t(7);
+}
+
+// A block lists the ids of its positions when that is smaller than a bitmap over all positions
+static bool listsPositions(size_t blockPositions, size_t positions) {
+	return pad8(2 * blockPositions) < 8 * ((positions + 63) / 64);
+}
+
+static size_t blockPositionBytes(size_t blockPositions, size_t positions) {
+	return listsPositions(blockPositions, positions) ? pad8(2 * blockPositions) : 8 * ((positions + 63) / 64);
+}
+
+static size_t summarySectionBytes(const std::vector<BlockSummary>& summaries, size_t positions) {
+	size_t bytes = 8 + pad8(2 * positions);
+	for (const BlockSummary& summary : summaries) bytes += detail::SUMMARY_BYTES + blockPositionBytes(summary.positions.size(), positions);
+	return bytes;
+}
+
+// Everything but codeBitOffset, which depends on the codec
+static std::vector<BlockSummary> buildSummaries(const BoardStream& boards) {
+	using namespace detail;
+
+	std::vector<BlockSummary> summaries(summaryBlocks(boards.size()));
+	std::vector<bool> seen(HuffmanTree::SYMBOL_COUNT);
+	PackedBoard packed[BATCH_BOARDS];
+	uint16_t codes[BATCH_BOARDS];
+	for (size_t base = 0; base < boards.size(); base += BATCH_BOARDS) {
+		const size_t count = std::min(BATCH_BOARDS, boards.size() - base);
+		packBoards(boards.data() + base, count, packed);
+		packedToFifteenBits(packed, count, codes);
+		BlockSummary& summary = summaries[base / SUMMARY_BLOCK_BOARDS];
+		for (size_t i = 0; i < count; i++) {
+			if (seen[codes[i]]) continue;
+			seen[codes[i]] = true;
+			summary.positions.push_back(codes[i]);
+		}
+		static_assert(SUMMARY_BLOCK_BOARDS % BATCH_BOARDS == 0, "a batch must not straddle two blocks");
+		if ((base + count) % SUMMARY_BLOCK_BOARDS == 0 || base + count == boards.size()) {
+			for (uint16_t code : summary.positions) seen[code] = false;
+			std::sort(summary.positions.begin(), summary.positions.end());
+		}
+	}
+
+	size_t game = 0;
+	forEachGame(boards.data(), boards.size(), [&](size_t start, size_t count) {
+		BlockSummary& summary = summaries[start / SUMMARY_BLOCK_BOARDS];
+		summary.games++;
+		summary.gameLengths[std::min<size_t>(count, 9) - 1]++;
+		const PackedBoard last = packBoard(boards[start + count - 1]);
+		if (packedIsWinner(last, Square::X)) summary.xWins++;
+		else if (packedIsWinner(last, Square::O)) summary.oWins++;
+		// Every block starting inside this game gets its index
+		for (size_t block = (start + SUMMARY_BLOCK_BOARDS - 1) / SUMMARY_BLOCK_BOARDS; block * SUMMARY_BLOCK_BOARDS < start + count; block++) {
+			summaries[block].gameIndex = game;
+		}
+		game++;
+	});
+
+	for (size_t block = 0; block < summaries.size(); block++) {
+		summaries[block].firstBoard = block * SUMMARY_BLOCK_BOARDS;
+		summaries[block].boards = std::min(SUMMARY_BLOCK_BOARDS, boards.size() - summaries[block].firstBoard);
+	}
+	return summaries;
+}
+
+// Distinct codes of all blocks, ascending
+static std::vector<uint16_t> summaryPositions(const std::vector<BlockSummary>& summaries) {
+	std::vector<bool> seen(HuffmanTree::SYMBOL_COUNT);
+	for (const BlockSummary& summary : summaries) {
+		for (uint16_t code : summary.positions) seen[code] = true;
+	}
+	std::vector<uint16_t> positions;
+	for (size_t code = 0; code < seen.size(); code++) {
+		if (seen[code]) positions.push_back(uint16_t(code));
+	}
+	return positions;
+}
+
+static void writeSummaries(uint8_t* out, const std::vector<BlockSummary>& summaries, const std::vector<uint16_t>& positions) {
+	using namespace detail;
+
+	std::vector<uint16_t> index(HuffmanTree::SYMBOL_COUNT);
+	putU64(out, positions.size());
+	for (size_t i = 0; i < positions.size(); i++) {
+		out[8 + 2 * i] = uint8_t(positions[i]);
+		out[9 + 2 * i] = uint8_t(positions[i] >> 8);
+		index[positions[i]] = uint16_t(i);
+	}
+	out += 8 + pad8(2 * positions.size());
+
+	for (const BlockSummary& summary : summaries) {
+		putU64(out + 0, summary.codeBitOffset);
+		putU64(out + 8, summary.gameIndex);
+		putU32(out + 16, summary.games);
+		putU32(out + 20, summary.xWins);
+		putU32(out + 24, summary.oWins);
+		for (size_t i = 0; i < summary.gameLengths.size(); i++) putU32(out + 28 + 4 * i, summary.gameLengths[i]);
+		putU64(out + 64, summary.positions.size());
+		uint8_t* ids = out + SUMMARY_BYTES;
+		const size_t idBytes = blockPositionBytes(summary.positions.size(), positions.size());
+		std::fill(ids, ids + idBytes, 0);
+		if (listsPositions(summary.positions.size(), positions.size())) {
+			for (size_t i = 0; i < summary.positions.size(); i++) {
+				ids[2 * i] = uint8_t(index[summary.positions[i]]);
+				ids[2 * i + 1] = uint8_t(index[summary.positions[i]] >> 8);
+			}
+		} else {
+			for (uint16_t code : summary.positions) ids[index[code] >> 3] |= 1 << (index[code] & 7);
+		}
+		out += SUMMARY_BYTES + idBytes;
+	}
+}
+
+static std::vector<BlockSummary> readSummaries(const uint8_t* in, size_t bytes, size_t boards) {
+	using namespace detail;
+
+	if (bytes < 8) return {};
+	const uint64_t positionCount = getU64(in);
+	if (positionCount > HuffmanTree::SYMBOL_COUNT) return {};
+	size_t used = 8 + pad8(2 * positionCount);
+	if (used > bytes) return {};
+	std::vector<uint16_t> positions(positionCount);
+	for (size_t i = 0; i < positions.size(); i++) positions[i] = uint16_t(in[8 + 2 * i] | in[9 + 2 * i] << 8);
+
+	std::vector<BlockSummary> summaries(summaryBlocks(boards));
+	for (size_t block = 0; block < summaries.size(); block++) {
+		if (bytes - used < SUMMARY_BYTES) return {};
+		const uint8_t* entry = in + used;
+		BlockSummary& summary = summaries[block];
+		summary.firstBoard = block * SUMMARY_BLOCK_BOARDS;
+		summary.boards = std::min<uint64_t>(SUMMARY_BLOCK_BOARDS, boards - summary.firstBoard);
+		summary.codeBitOffset = getU64(entry + 0);
+		summary.gameIndex = getU64(entry + 8);
+		summary.games = getU32(entry + 16);
+		summary.xWins = getU32(entry + 20);
+		summary.oWins = getU32(entry + 24);
+		for (size_t i = 0; i < summary.gameLengths.size(); i++) summary.gameLengths[i] = getU32(entry + 28 + 4 * i);
+		const uint64_t blockPositions = getU64(entry + 64);
+		if (blockPositions > positions.size()) return {};
+		used += SUMMARY_BYTES;
+		const size_t idBytes = blockPositionBytes(blockPositions, positions.size());
+		if (bytes - used < idBytes) return {};
+
+		const uint8_t* ids = in + used;
+		if (listsPositions(blockPositions, positions.size())) {
+			for (size_t i = 0; i < blockPositions; i++) {
+				const uint16_t id = uint16_t(ids[2 * i] | ids[2 * i + 1] << 8);
+				if (id >= positions.size()) return {};
+				summary.positions.push_back(positions[id]);
+			}
+		} else {
+			for (size_t i = 0; i < positions.size(); i++) {
+				if (ids[i >> 3] >> (i & 7) & 1) summary.positions.push_back(positions[i]);
+			}
+			if (summary.positions.size() != blockPositions) return {};
+		}
+		used += idBytes;
+	}
+	return used == bytes ? summaries : std::vector<BlockSummary>{};
+}
+
+// Per game coding decisions, an empty vector means the stage is off
+struct StreamPlan {
+	ByteVector transforms;          // symmetry transform of every game
+	std::vector<uint32_t> gameIds;  // dictionary id of every game
+	size_t uniqueGames = 0;
+	size_t codedBoards = 0;
+
+	bool perGame() const { return !transforms.empty() || !gameIds.empty(); }
+};
+
+static StreamPlan planStream(const BoardStream& boards, const EncodeOptions& options) {
+	StreamPlan plan;
+	plan.codedBoards = boards.size();
+
+	if (options.canonicalizeSymmetry) {
+		forEachGame(boards.data(), boards.size(), [&](size_t start, size_t count) {
+			plan.transforms.push_back(canonicalTransform(boards.data() + start, count));
+		});
+	}
+
+	if (options.deduplicateGames) {
+		GameDictionary dictionary(boards);
+		plan.codedBoards = 0;
+		forEachGame(boards.data(), boards.size(), [&](size_t start, size_t count) {
+			uint8_t transform = plan.transforms.empty() ? 0 : plan.transforms[plan.gameIds.size()];
+			uint32_t id = dictionary.insert(start, count, transform);
+			if (id == plan.uniqueGames) {
+				plan.uniqueGames++;
+				plan.codedBoards += count;
+			}
+			plan.gameIds.push_back(id);
+		});
+	}
+	return plan;
+}
+
+// Calls fn(code) for every board that is coded, in order, turned by its
+// game's transform
+template <typename Fn>
+static void forEachCode(const BoardStream& boards, const StreamPlan& plan, Fn fn) {
+	using namespace detail;
+
+	if (!plan.perGame()) {
+		PackedBoard packed[BATCH_BOARDS];
+		uint16_t codes[BATCH_BOARDS];
+		for (size_t base = 0; base < boards.size(); base += BATCH_BOARDS) {
+			const size_t count = std::min(BATCH_BOARDS, boards.size() - base);
+			packBoards(boards.data() + base, count, packed);
+			packedToFifteenBits(packed, count, codes);
+			for (size_t i = 0; i < count; i++) fn(codes[i]);
+		}
+		return;
+	}
+	size_t game = 0;
+	uint32_t coded = 0;
+	forEachGame(boards.data(), boards.size(), [&](size_t start, size_t count) {
+		const size_t g = game++;
+		if (!plan.gameIds.empty()) {
+			if (plan.gameIds[g] != coded) return; // repeat, lives in the game table
+			coded++;
+		}
+		const uint8_t transform = plan.transforms.empty() ? 0 : plan.transforms[g];
+		for (size_t i = start; i < start + count; i++) {
+			fn(boardToFifteenBit(transform == 0 ? boards[i] : transformBoard(boards[i], transform)));
+		}
+	});
+}
+
+static CompressionLevel chooseCodec(const std::vector<size_t>& freq, size_t samples, size_t codedBoards, double targetRatio) {
+	size_t distinct = 0;
+	double entropy = 0.0;
+	for (size_t count : freq) {
+		if (count == 0) continue;
+		double p = double(count) / samples;
+		entropy -= p * std::log2(p);
+		distinct++;
+	}
+	entropy += (distinct - 1) / (2.0 * samples * std::log(2.0));
+
+	const double rawBits = codedBoards * 15.0;
+	const double bitsPerBoard = distinct > 1 ? std::max(entropy, 1.0) : 0.0;
+	const double huffmanBits = codedBoards * bitsPerBoard + distinct * 17.0;
+
+	if (targetRatio >= 1.0) return CompressionLevel::raw;
+	if (huffmanBits <= rawBits * targetRatio) return CompressionLevel::huffman;
+	return CompressionLevel::raw;
+}
+
+ByteVector encodeBoards(const BoardStream& boards, const EncodeOptions& options) {
+	using namespace detail;
+
+	ByteVector outData(HEADER_BYTES, 0);
+	FrameHeader header;
+	header.boards = boards.size();
+	if (boards.empty()) {
+		writeHeader(outData.data(), header);
+		return outData;
+	}
+
+	const StreamPlan plan = planStream(boards, options);
+	header.codedBoards = plan.codedBoards;
+	if (options.canonicalizeSymmetry) {
+		header.flags |= FLAG_SYMMETRY;
+		header.transformBytes = (plan.transforms.size() * 3 + 7) >> 3;
+	}
+	const uint8_t idBits = bitWidth(plan.uniqueGames);
+	if (options.deduplicateGames) {
+		header.flags |= FLAG_DEDUP;
+		const size_t repeats = plan.gameIds.size() - plan.uniqueGames;
+		header.dedupBytes = (plan.gameIds.size() + repeats * idBits + 7) >> 3;
+	}
+	std::vector<BlockSummary> summaries;
+	std::vector<uint16_t> summaryCodes;
+	if (options.blockSummaries) {
+		summaries = buildSummaries(boards);
+		summaryCodes = summaryPositions(summaries);
+		header.flags |= FLAG_SUMMARY;
+		header.summaryBytes = summarySectionBytes(summaries, summaryCodes.size());
+	}
+
+	std::vector<size_t> freq;
+	header.codec = options.level;
+	if (header.codec == CompressionLevel::automatic) {
+		freq.assign(HuffmanTree::SYMBOL_COUNT, 0);
+		size_t samples = 0;
+		if (plan.perGame()) {
+			forEachCode(boards, plan, [&](uint16_t code) { ++freq[code]; });
+			samples = plan.codedBoards;
+		} else {
+			const size_t step = std::max<size_t>(1, boards.size() / SAMPLE_BOARDS);
+			for (size_t i = 0; i < boards.size(); i += step, samples++) {
+				++freq[boardToFifteenBit(boards[i])];
+			}
+		}
+		header.codec = chooseCodec(freq, samples, plan.codedBoards, options.targetRatio);
+		if (!plan.perGame()) freq.clear();
+	}
+
+	const size_t sectionBytes = header.transformBytes + header.dedupBytes + header.summaryBytes;
+	auto frameBytes = [&] {
+		const size_t bodyBytes = HEADER_BYTES + header.treeBytes + header.memBytes + sectionBytes;
+		return bodyBytes + (options.checksums ? checksumBytesFor(bodyBytes, boards.size()) : 0);
+	};
+	std::vector<size_t> blockBits; // Huffman: bit offset of every SUMMARY_BLOCK_BOARDS-th code
+	if (header.codec == CompressionLevel::raw) {
+		header.memBytes = (plan.codedBoards * 15 + 7) >> 3;
+		outData.reserve(frameBytes());
+
+		BitWriter writer(outData);
+		forEachCode(boards, plan, [&](uint16_t code) { writer.write(code, 15); });
+		writer.flush();
+	} else {
+		if (freq.empty()) {
+			freq.assign(HuffmanTree::SYMBOL_COUNT, 0);
+			forEachCode(boards, plan, [&](uint16_t code) { ++freq[code]; });
+		}
+
+		HuffmanTree tree(freq);
+		ByteVector treeMemory = tree.getHuffmanTree();
+		header.treeBytes = treeMemory.size();
+		header.memBytes = (tree.encodedBits(freq) + 7) >> 3;
+
+		outData.reserve(frameBytes());
+		outData.insert(outData.end(), treeMemory.begin(), treeMemory.end());
+
+		BitWriter writer(outData);
+		size_t coded = 0;
+		size_t codedBits = 0;
+		forEachCode(boards, plan, [&](uint16_t code) {
+			if (coded++ % SUMMARY_BLOCK_BOARDS == 0) blockBits.push_back(codedBits);
+			codedBits += tree.codeLength(code);
+			tree.encode(code, writer);
+		});
+		writer.flush();
+	}
+
+	BitWriter transformWriter(outData);
+	for (uint8_t transform : plan.transforms) {
+		transformWriter.write(transform, 3);
+	}
+	transformWriter.flush();
+
+	BitWriter dedupWriter(outData);
+	uint32_t coded = 0;
+	for (uint32_t id : plan.gameIds) {
+		if (id == coded) {
+			dedupWriter.write(0, 1);
+			coded++;
+		} else {
+			dedupWriter.write(1 | uint64_t(id) << 1, idBits + 1);
+		}
+	}
+	dedupWriter.flush();
+
+	if (options.blockSummaries) {
+		for (size_t block = 0; block < summaries.size() && !options.deduplicateGames; block++) {
+			summaries[block].codeBitOffset = header.codec == CompressionLevel::raw ? summaries[block].firstBoard * 15 : blockBits[block];
+		}
+		const size_t offset = outData.size();
+		outData.resize(offset + header.summaryBytes);
+		writeSummaries(outData.data() + offset, summaries, summaryCodes);
+	}
+
+	if (!options.checksums && boards.size() / MAX_BOARDS_PER_BYTE < outData.size()) {
+		writeHeader(outData.data(), header);
+		return outData;
+	}
+
+	const size_t bodyBytes = outData.size();
+	header.flags |= FLAG_CHECKSUM;
+	header.checksumBytes = checksumBytesFor(bodyBytes, boards.size());
+	writeHeader(outData.data(), header);
+
+	for (size_t start = 0; start < bodyBytes; start += CHECK_BLOCK_BYTES) {
+		appendU32(outData, crc32c(outData.data() + start, std::min(CHECK_BLOCK_BYTES, bodyBytes - start)));
+	}
+	for (size_t block = 0; block * CHECK_BLOCK_BOARDS < boards.size(); block++) {
+		appendU32(outData, boardBlockChecksum(boards.data(), boards.size(), block));
+	}
+	return outData;
+}
+
+static size_t bodyBytesOf(const FrameHeader& header) {
+	return detail::HEADER_BYTES + header.treeBytes + header.memBytes + header.transformBytes + header.dedupBytes + header.summaryBytes;
+}
+
+// Checks the header against the frame it came from. Every field is untrusted
+// until this returns true, afterwards the section sizes sum without overflow.
+static bool validFrame(const ByteVector& inData, const FrameHeader& header) {
+	using namespace detail;
+
+	if (header.magic != FRAME_MAGIC || header.version != FRAME_VERSION) return false;
+	if (header.boards == 0) return false;
+	uint64_t bodyBytes = HEADER_BYTES;
+	for (uint64_t sectionBytes : { header.treeBytes, header.memBytes, header.transformBytes, header.dedupBytes, header.summaryBytes }) {
+		if (!addChecked(bodyBytes, sectionBytes)) return false;
+	}
+	uint64_t frameBytes = bodyBytes;
+	if (!addChecked(frameBytes, header.checksumBytes) || frameBytes != inData.size()) return false;
+
+	if (header.boards / MAX_BOARDS_PER_BYTE >= inData.size()) return false;
+	if (header.codedBoards > header.boards) return false;
+	if (!(header.flags & FLAG_DEDUP) && header.codedBoards != header.boards) return false;
+	if (header.codec == CompressionLevel::raw && header.codedBoards > header.memBytes * 8 / 15) return false;
+	if ((header.flags & FLAG_CHECKSUM) && header.checksumBytes != checksumBytesFor(bodyBytes, header.boards)) return false;
+	return true;
+}
+
+// Decodes a valid frame into boards[0, header.boards), checksums are left to the caller
+static bool decodeFrameInto(const ByteVector& inData, const FrameHeader& header, Board* boards, DecodeWorkspace& workspace) {
+	using namespace detail;
+
+	const uint8_t* mem = inData.data() + HEADER_BYTES + header.treeBytes;
+	const uint8_t* transformSection = mem + header.memBytes;
+	const uint8_t* dedupSection = transformSection + header.transformBytes;
+
+	switch (header.codec) {
+	case CompressionLevel::raw:
+		memoryBlockToBoards(mem, header.memBytes, boards, header.codedBoards);
+		break;
+	case CompressionLevel::huffman:
+		if (!workspace.huffman.load(inData.data() + HEADER_BYTES, header.treeBytes)) return false;
+		workspace.codes.resize(header.codedBoards);
+		if (!workspace.huffman.decode(mem, header.memBytes, workspace.codes.data(), header.codedBoards)) return false;
+		for (size_t i = 0; i < header.codedBoards; i++) boards[i] = fifteenBitToBoard(workspace.codes[i]);
+		break;
+	default:
+		return false;
+	}
+
+	if (header.flags & FLAG_DEDUP) {
+		// Coded games sit in order at the front and every game of the output lands at or
+		// behind the coded games before it, so expanding back to front never overwrites a source
+		std::vector<size_t>& starts = workspace.gameStarts;
+		std::vector<uint32_t>& ids = workspace.gameIds;
+		starts.clear();
+		ids.clear();
+		forEachGame(boards, header.codedBoards, [&](size_t start, size_t /*count*/) { starts.push_back(start); });
+		starts.push_back(header.codedBoards);
+		const size_t uniqueGames = starts.size() - 1;
+		const uint8_t idBits = bitWidth(uniqueGames);
+
+		BitReader dedupReader(dedupSection, header.dedupBytes);
+		size_t coded = 0;
+		size_t expanded = 0;
+		while (expanded < header.boards) {
+			size_t id = dedupReader.read(1) ? dedupReader.read(idBits) : coded++;
+			if (id >= uniqueGames) return false;
+			ids.push_back(uint32_t(id));
+			expanded += starts[id + 1] - starts[id];
+		}
+		if (expanded != header.boards) return false;
+
+		for (size_t game = ids.size(); game-- > 0;) {
+			const size_t count = starts[ids[game] + 1] - starts[ids[game]];
+			expanded -= count;
+			std::memmove(boards + expanded, boards + starts[ids[game]], count * sizeof(Board));
+		}
+	}
+
+	if (header.flags & FLAG_SYMMETRY) {
+		BitReader transformReader(transformSection, header.transformBytes);
+		uint8_t inverse = 0;
+		for (size_t i = 0; i < header.boards; i++) {
+			if (i == 0 || startsGame(boards[i])) inverse = INVERSE[transformReader.read(3)];
+			boards[i] = transformBoard(boards[i], inverse);
+		}
+	}
+	return true;
+}
+
+static bool verifyBoardBlocks(const ByteVector& inData, const Board* boards, size_t boardCount) {
+	using namespace detail;
+
+	const size_t blocks = (boardCount + CHECK_BLOCK_BOARDS - 1) / CHECK_BLOCK_BOARDS;
+	const uint8_t* boardChecksums = inData.data() + inData.size() - 4 * blocks;
+	for (size_t block = 0; block < blocks; block++) {
+		if (boardBlockChecksum(boards, boardCount, block) != getU32(boardChecksums + 4 * block)) {
+			std::cerr << "Checksum mismatch in decoded board block " << block << '\n';
+			return false;
+		}
+	}
+	return true;
+}
+
+// decodeBoards, telling a frame that fails to decode from one without boards
+static std::optional<BoardStream> decodeChecked(const ByteVector& inData) {
+	using namespace detail;
+
+	if (inData.size() < HEADER_BYTES) return std::nullopt;
+	// The bare header encodeBoards writes for an empty stream, which validFrame refuses
+	uint8_t emptyHeader[HEADER_BYTES] = {};
+	writeHeader(emptyHeader, FrameHeader{});
+	if (inData.size() == HEADER_BYTES && memcmp(inData.data(), emptyHeader, HEADER_BYTES) == 0) return BoardStream{};
+	FrameHeader header = readHeader(inData.data());
+	if (!validFrame(inData, header)) return std::nullopt;
+
+	std::future<bool> compressedIntact;
+	if (header.flags & FLAG_CHECKSUM) {
+		const size_t bodyBytes = bodyBytesOf(header);
+		const size_t compressedBlocks = (bodyBytes + CHECK_BLOCK_BYTES - 1) / CHECK_BLOCK_BYTES;
+		const size_t trustedBlocks = std::min(compressedBlocks, (HEADER_BYTES + header.treeBytes + CHECK_BLOCK_BYTES - 1) / CHECK_BLOCK_BYTES);
+		if (!verifyCompressedBlocks(inData, bodyBytes, 0, trustedBlocks)) {
+			std::cerr << "Checksum mismatch in frame header or tree\n";
+			return std::nullopt;
+		}
+		compressedIntact = std::async(std::launch::async, verifyCompressedBlocks, std::cref(inData), bodyBytes, trustedBlocks, compressedBlocks);
+	}
+
+	BoardStream boards(header.boards);
+	DecodeWorkspace workspace;
+	if (!decodeFrameInto(inData, header, boards.data(), workspace)) return std::nullopt;
+
+	if (header.flags & FLAG_CHECKSUM) {
+		if (!compressedIntact.get()) {
+			std::cerr << "Checksum mismatch in compressed data\n";
+			return std::nullopt;
+		}
+		if (!verifyBoardBlocks(inData, boards.data(), boards.size())) return std::nullopt;
+	}
+	return boards;
+}
+
+BoardStream decodeBoards(const ByteVector& inData) {
+	std::optional<BoardStream> boards = decodeChecked(inData);
+	return boards ? std::move(*boards) : BoardStream{};
+}
+
+size_t decodedBoardCount(const ByteVector& inData) {
+	if (inData.size() < detail::HEADER_BYTES) return 0;
+	FrameHeader header = readHeader(inData.data());
+	return validFrame(inData, header) ? header.boards : 0;
+}
+
+size_t decodeBoardsInto(const ByteVector& inData, std::span<Board> boards, DecodeWorkspace& workspace) {
+	using namespace detail;
+
+	if (inData.size() < HEADER_BYTES) return 0;
+	FrameHeader header = readHeader(inData.data());
+	if (!validFrame(inData, header) || boards.size() < header.boards) return 0;
+
+	if (header.flags & FLAG_CHECKSUM) {
+		// Verified on this thread before decoding, a helper thread would allocate
+		const size_t bodyBytes = bodyBytesOf(header);
+		if (!verifyCompressedBlocks(inData, bodyBytes, 0, (bodyBytes + CHECK_BLOCK_BYTES - 1) / CHECK_BLOCK_BYTES)) {
+			std::cerr << "Checksum mismatch in compressed data\n";
+			return 0;
+		}
+	}
+	if (!decodeFrameInto(inData, header, boards.data(), workspace)) return 0;
+	if ((header.flags & FLAG_CHECKSUM) && !verifyBoardBlocks(inData, boards.data(), header.boards)) return 0;
+	return header.boards;
+}
+
+// Checks the checksum blocks covering frame bytes [begin, end), frames without FLAG_CHECKSUM pass
+static bool verifyFrameRange(const ByteVector& inData, const FrameHeader& header, size_t begin, size_t end) {
+	using namespace detail;
+
+	if (!(header.flags & FLAG_CHECKSUM) || begin >= end) return true;
+	const size_t bodyBytes = bodyBytesOf(header);
+	const size_t last = (std::min(end, bodyBytes) + CHECK_BLOCK_BYTES - 1) / CHECK_BLOCK_BYTES;
+	if (verifyCompressedBlocks(inData, bodyBytes, begin / CHECK_BLOCK_BYTES, last)) return true;
+	std::cerr << "Checksum mismatch in compressed data\n";
+	return false;
+}
+
+std::vector<BlockSummary> readBlockSummaries(const ByteVector& inData) {
+	using namespace detail;
+
+	if (inData.size() < HEADER_BYTES) return {};
+	FrameHeader header = readHeader(inData.data());
+	if (!validFrame(inData, header) || !(header.flags & FLAG_SUMMARY)) return {};
+
+	const size_t summaryStart = bodyBytesOf(header) - header.summaryBytes;
+	if (!verifyFrameRange(inData, header, 0, HEADER_BYTES) || !verifyFrameRange(inData, header, summaryStart, summaryStart + header.summaryBytes)) return {};
+	return readSummaries(inData.data() + summaryStart, header.summaryBytes, header.boards);
+}
+
+std::optional<StreamSummary> summarizeFrame(const ByteVector& inData) {
+	std::vector<BlockSummary> summaries = readBlockSummaries(inData);
+	if (summaries.empty()) {
+		const std::optional<BoardStream> boards = decodeChecked(inData);
+		if (!boards) return std::nullopt;
+		summaries = buildSummaries(*boards);
+	}
+
+	StreamSummary total;
+	for (const BlockSummary& summary : summaries) {
+		total.boards += summary.boards;
+		total.games += summary.games;
+		total.xWins += summary.xWins;
+		total.oWins += summary.oWins;
+		for (size_t i = 0; i < total.gameLengths.size(); i++) total.gameLengths[i] += summary.gameLengths[i];
+	}
+	return total;
+}
+
+// Bit offset just past the codes of summaries[block], where the next block starts
+static uint64_t codeEndBit(const FrameHeader& header, const std::vector<BlockSummary>& summaries, size_t block) {
+	return block + 1 < summaries.size() ? summaries[block + 1].codeBitOffset : header.memBytes * 8;
+}
+
+// Calls fn(code, transform) for every board of a block, straight from the coded boards
+// [block.codeBitOffset, endBit). Needs a frame without FLAG_DEDUP; the Huffman decoder
+// must hold the frame's tree.
+template <typename Fn>
+static bool scanBlock(const ByteVector& inData, const FrameHeader& header, const BlockSummary& block, uint64_t endBit, DecodeWorkspace& workspace, Fn fn) {
+	using namespace detail;
+
+	const size_t memStart = HEADER_BYTES + header.treeBytes;
+	const uint8_t* mem = inData.data() + memStart;
+	if (block.codeBitOffset > endBit || endBit > header.memBytes * 8) return false;
+	if ((header.flags & FLAG_SYMMETRY) && block.gameIndex > header.transformBytes * 8 / 3) return false;
+	if (!verifyFrameRange(inData, header, memStart + block.codeBitOffset / 8, memStart + (endBit + 7) / 8)) return false;
+	std::vector<uint16_t>& codes = workspace.codes;
+	codes.resize(block.boards);
+	if (header.codec == CompressionLevel::raw) {
+		BitReader reader(mem, header.memBytes);
+		reader.skip(block.codeBitOffset);
+		for (uint16_t& code : codes) code = uint16_t(reader.read(15));
+		if (reader.position() > header.memBytes * 8) return false;
+	} else if (!workspace.huffman.decode(mem, header.memBytes, codes.data(), codes.size(), block.codeBitOffset)) {
+		return false;
+	}
+
+	const bool symmetry = header.flags & FLAG_SYMMETRY;
+	BitReader transformReader(mem + header.memBytes, header.transformBytes);
+	transformReader.skip(3 * block.gameIndex);
+	uint8_t transform = symmetry ? uint8_t(transformReader.read(3)) : 0;
+	for (size_t i = 0; i < codes.size(); i++) {
+		if (symmetry && i > 0 && packedMarks(fifteenBitToPacked(codes[i])) <= 1) transform = uint8_t(transformReader.read(3));
+		fn(codes[i], transform);
+	}
+	return true;
+}
+
+// Header of a frame whose blocks scanBlock can walk, loading its tree into the workspace
+static bool prepareScan(const ByteVector& inData, FrameHeader& header, DecodeWorkspace& workspace) {
+	using namespace detail;
+
+	if (inData.size() < HEADER_BYTES) return false;
+	header = readHeader(inData.data());
+	if (!validFrame(inData, header)) return false;
+	if (!(header.flags & FLAG_SUMMARY) || (header.flags & FLAG_DEDUP)) return false;
+	const size_t transformStart = HEADER_BYTES + header.treeBytes + header.memBytes;
+	if (!verifyFrameRange(inData, header, 0, HEADER_BYTES + header.treeBytes)) return false;
+	if (!verifyFrameRange(inData, header, transformStart, transformStart + header.transformBytes)) return false;
+	if (header.codec == CompressionLevel::huffman) return workspace.huffman.load(inData.data() + HEADER_BYTES, header.treeBytes);
+	return header.codec == CompressionLevel::raw;
+}
+
+std::optional<uint64_t> countPosition(const ByteVector& inData, const Board& board) {
+	const std::vector<BlockSummary> summaries = readBlockSummaries(inData);
+	FrameHeader header;
+	DecodeWorkspace workspace;
+	if (summaries.empty() || !prepareScan(inData, header, workspace)) {
+		const std::optional<BoardStream> boards = decodeChecked(inData);
+		if (!boards) return std::nullopt;
+		uint64_t count = 0;
+		for (const Board& decoded : *boards) count += memcmp(&decoded, &board, sizeof(Board)) == 0;
+		return count;
+	}
+
+	// The codes are stored turned by their game's transform, so compare against the board turned the same way
+	uint16_t targets[8];
+	for (uint8_t transform = 0; transform < 8; transform++) targets[transform] = boardToFifteenBit(transformBoard(board, transform));
+
+	uint64_t count = 0;
+	for (size_t block = 0; block < summaries.size(); block++) {
+		if (!summaries[block].contains(board)) continue;
+		const bool intact = scanBlock(inData, header, summaries[block], codeEndBit(header, summaries, block), workspace,
+			[&](uint16_t code, uint8_t transform) { count += code == targets[transform]; });
+		if (!intact) return std::nullopt;
+	}
+	return count;
+}
+
+std::optional<BoardStream> selectBoards(const ByteVector& inData, const std::function<bool(const BlockSummary&)>& filter) {
+	using namespace detail;
+
+	const std::vector<BlockSummary> summaries = readBlockSummaries(inData);
+	FrameHeader header;
+	DecodeWorkspace workspace;
+	BoardStream selected;
+	if (summaries.empty() || !prepareScan(inData, header, workspace)) {
+		const std::optional<BoardStream> boards = decodeChecked(inData);
+		if (!boards) return std::nullopt;
+		for (const BlockSummary& block : summaries.empty() ? buildSummaries(*boards) : summaries) {
+			if (filter(block)) selected.insert(selected.end(), boards->begin() + block.firstBoard, boards->begin() + block.firstBoard + block.boards);
+		}
+		return selected;
+	}
+
+	for (size_t block = 0; block < summaries.size(); block++) {
+		if (!filter(summaries[block])) continue;
+		const bool intact = scanBlock(inData, header, summaries[block], codeEndBit(header, summaries, block), workspace, [&](uint16_t code, uint8_t transform) {
+			const Board board = fifteenBitToBoard(code);
+			selected.push_back(transform == 0 ? board : transformBoard(board, INVERSE[transform]));
 		});
+		if (!intact) return std::nullopt;
+	}
+	return selected;
+}
 
-	//Data
-	outData.insert(outData.end(), treeMemory.begin(), treeMemory.end());
-	outData.insert(outData.end(), memory.begin(), memory.end());
-	sendData(IP, port, outData);
+bool streamOutBoards(const BoardStream& boards, std::string IP, size_t port, const EncodeOptions& options) {
+	return sendData(IP, port, encodeBoards(boards, options));
 }
 
 BoardStream streamInBoards(std::string IP, size_t port) {
-	ByteVector inData = getData(IP, port);
+	return decodeBoards(getData(IP, port));
+}
 
-	if (inData.size() < 24) return {};
-	size_t treeBytes = size_t(inData[0]) << 8 * 0 | size_t(inData[1]) << 8 * 1 | size_t(inData[2]) << 8 * 2 | size_t(inData[3]) << 8 * 3 | size_t(inData[4]) << 8 * 4 | size_t(inData[5]) << 8 * 5 | size_t(inData[6]) << 8 * 6 | size_t(inData[7]) << 8 * 7;
-	size_t memBytes = size_t(inData[8]) << 8 * 0 | size_t(inData[9]) << 8 * 1 | size_t(inData[10]) << 8 * 2 | size_t(inData[11]) << 8 * 3 | size_t(inData[12]) << 8 * 4 | size_t(inData[13]) << 8 * 5 | size_t(inData[14]) << 8 * 6 | size_t(inData[15]) << 8 * 7;
-	size_t boards = size_t(inData[16]) << 8 * 0 | size_t(inData[17]) << 8 * 1 | size_t(inData[18]) << 8 * 2 | size_t(inData[19]) << 8 * 3 | size_t(inData[20]) << 8 * 4 | size_t(inData[21]) << 8 * 5 | size_t(inData[22]) << 8 * 6 | size_t(inData[23]) << 8 * 7;
+std::vector<TransferStatus> streamOutBoardsToAll(const BoardStream& boards, const std::vector<Endpoint>& destinations, const EncodeOptions& options,
+	std::function<void(size_t destination, const TransferStatus&)> onProgress) {
+	return sendDataToAll(destinations, encodeBoards(boards, options), std::move(onProgress));
+}
 
-	if (inData.size() != 24 + treeBytes + memBytes) return {};
-	HuffmanTree tree(inData.data() + 24, treeBytes);
-	ByteVector mem = tree.deserialization(inData.data() + 24 + treeBytes, memBytes, boards);
+// Runs work() on the pool and resumes the calling coroutine on its own executor with the result
+template <typename F>
+static auto runOnWorkers(asio::thread_pool& workers, F work) -> asio::awaitable<decltype(work())> {
+	co_return co_await asio::co_spawn(workers, [&work]() -> asio::awaitable<decltype(work())> { co_return work(); }, asio::use_awaitable);
+}
 
-	return memoryBlockToBoards(mem.data(), mem.size(), boards);
+// The frame and its contentHash, so neither is computed on the io thread
+static std::pair<ByteVector, uint64_t> encodeAndHash(const BoardStream& boards, const EncodeOptions& options) {
+	ByteVector frame = encodeBoards(boards, options);
+	const uint64_t hash = contentHash(frame.data(), frame.size());
+	return { std::move(frame), hash };
+}
+
+asio::awaitable<bool> asyncStreamOutBoards(const BoardStream& boards, std::string IP, size_t port, asio::thread_pool& workers, EncodeOptions options) {
+	auto [frame, hash] = co_await runOnWorkers(workers, [&] { return encodeAndHash(boards, options); });
+	TransferStatus status;
+	co_return co_await asyncSendData(IP, uint32_t(port), frame, hash, status);
+}
+
+asio::awaitable<BoardStream> asyncStreamInBoards(std::string IP, size_t port, asio::thread_pool& workers) {
+	ByteVector frame = co_await asyncGetData(IP, uint32_t(port));
+	co_return co_await runOnWorkers(workers, [&] { return decodeBoards(frame); });
+}
+
+asio::awaitable<std::vector<TransferStatus>> asyncStreamOutBoardsToAll(const BoardStream& boards, std::vector<Endpoint> destinations, asio::thread_pool& workers,
+	EncodeOptions options, std::function<void(size_t destination, const TransferStatus&)> onProgress) {
+	auto [frame, hash] = co_await runOnWorkers(workers, [&] { return encodeAndHash(boards, options); });
+	co_return co_await asyncSendDataToAll(std::move(destinations), frame, hash, std::move(onProgress));
 }
 
 BoardStream extractBoardsFromGames(const GameList& games) {
@@ -46,27 +981,29 @@ BoardStream extractBoardsFromGames(const GameList& games) {
 }
 
 GameList reconstructGamesFromBoards(const BoardStream& boards) {
+	using namespace detail;
+
 	GameList games;
 	Game game;
-	for (const Board& board : boards) {
-		int count = 0;
-		for (int i = 0; i < 3; i++) {
-			for (int j = 0; j < 3; j++) {
-				count += (board.squares[i][j] != none);
-				if (count > 1) break;
+	PackedBoard packed[BATCH_BOARDS];
+	uint8_t marks[BATCH_BOARDS];
+	for (size_t base = 0; base < boards.size(); base += BATCH_BOARDS) {
+		const size_t count = std::min(BATCH_BOARDS, boards.size() - base);
+		packBoards(boards.data() + base, count, packed);
+		countMarks(packed, count, marks);
+		for (size_t i = 0; i < count; i++) {
+			const Board& board = boards[base + i];
+			if (marks[i] > 1) {
+				game.boards.push_back(board);
+			} else if (marks[i] == 1) {
+				if (!game.boards.empty()) games.push_back(std::move(game));
+				game = Game{};
+				game.boards.push_back(board);
+			} else {
+				throw (std::string)"A board is empty";
 			}
-			if (count > 1) break;
-		}
-		if (count > 1) {
-			game.boards.push_back(board);
-		} else if(count == 1) {
-			if(!game.boards.empty()) games.push_back(game);
-			game = Game{};
-			game.boards.push_back(board);
-		} else {
-			throw (std::string)"A board is empty";
 		}
 	}
-	if (!game.boards.empty()) games.push_back(game);
+	if (!game.boards.empty()) games.push_back(std::move(game));
 	return games;
-}
+}
\ No newline at end of file
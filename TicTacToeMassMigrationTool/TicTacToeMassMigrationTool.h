@@ -1,15 +1,131 @@
 #pragma once
 
+#include <array>
+#include <functional>
+#include <optional>
 #include <vector>
+#include <span>
 #include <string>
 
 #include "BaseTypes.h"
 #include "NetworkStreamHandler.h"
 #include "BoardConverter.h"
 #include "HuffmanTree.h"
+#include "BoardSymmetry.h"
+#include "GameDictionary.h"
+#include "Checksum.h"
 
-void streamOutBoards(const BoardStream& boards, std::string IP, size_t port);
+namespace detail {
+	constexpr size_t HEADER_BYTES = 72;
+	constexpr size_t SAMPLE_BOARDS = 1 << 16;
+	constexpr size_t BATCH_BOARDS = 1 << 10;
+	constexpr size_t CHECK_BLOCK_BYTES = 1 << 16;
+	constexpr size_t CHECK_BLOCK_BOARDS = 1 << 13;
+	constexpr size_t SUMMARY_BLOCK_BOARDS = 1 << 13;
+	constexpr size_t SUMMARY_BYTES = 72;
+	// "TTTF" and the layout revision, in the upper bytes of the format field
+	constexpr uint32_t FRAME_MAGIC = 0x4654'5454;
+	constexpr uint16_t FRAME_VERSION = 2;
+	// Densest frame the decoder allocates for, what a checksum section alone guarantees
+	constexpr size_t MAX_BOARDS_PER_BYTE = CHECK_BLOCK_BOARDS / 4;
+
+	constexpr uint8_t FLAG_SYMMETRY = 1 << 0;
+	constexpr uint8_t FLAG_DEDUP = 1 << 1;
+	constexpr uint8_t FLAG_CHECKSUM = 1 << 2;
+	constexpr uint8_t FLAG_SUMMARY = 1 << 3;
+}
+
+enum class CompressionLevel : uint8_t {
+	raw,        // 15-bit packed boards
+	huffman,    // Huffman coded 15-bit boards
+	automatic   // estimate the entropy of a sample and pick one of the above
+};
+
+struct EncodeOptions {
+	CompressionLevel level = CompressionLevel::automatic;
+	// automatic: use the cheapest codec expected to reach this fraction of the raw size
+	double targetRatio = 0.9;
+	// store every game in its canonical orientation plus a 3-bit transform id
+	bool canonicalizeSymmetry = false;
+	// code repeated games as a reference to their first occurrence
+	bool deduplicateGames = false;
+	// crc32c per block of the frame and of the decoded boards
+	bool checksums = true;
+	// game statistics and the boards present per block of boards, see BlockSummary
+	bool blockSummaries = false;
+};
+
+// Scratch space of decodeBoardsInto. Keeps its capacity between calls, so
+// reusing one workspace per thread makes repeated decoding allocation free.
+struct DecodeWorkspace {
+	HuffmanDecoder huffman;
+	std::vector<uint16_t> codes;
+	std::vector<size_t> gameStarts;
+	std::vector<uint32_t> gameIds;
+};
+
+ByteVector encodeBoards(const BoardStream& boards, const EncodeOptions& options = {});
+BoardStream decodeBoards(const ByteVector& inData);
+
+// Exact number of boards decodeBoardsInto writes for this frame, 0 if it is not a valid frame
+size_t decodedBoardCount(const ByteVector& inData);
+// Decodes into caller storage of at least decodedBoardCount() boards. Returns the
+// number of boards written, 0 on error.
+size_t decodeBoardsInto(const ByteVector& inData, std::span<Board> boards, DecodeWorkspace& workspace);
+
+bool streamOutBoards(const BoardStream& boards, std::string IP, size_t port, const EncodeOptions& options = {});
 BoardStream streamInBoards(std::string IP, size_t port);
+// Encodes once and sends the frame to every destination concurrently. Each
+// destination reports its own progress and errors; see TransferStatus.
+std::vector<TransferStatus> streamOutBoardsToAll(const BoardStream& boards, const std::vector<Endpoint>& destinations, const EncodeOptions& options = {},
+	std::function<void(size_t destination, const TransferStatus&)> onProgress = {});
+
+// Coroutine versions: network I/O suspends on a strand of the calling executor,
+// which may be multi-threaded, encoding and decoding run on `workers`. `boards`
+// must stay alive until completion.
+asio::awaitable<bool> asyncStreamOutBoards(const BoardStream& boards, std::string IP, size_t port, asio::thread_pool& workers, EncodeOptions options = {});
+asio::awaitable<BoardStream> asyncStreamInBoards(std::string IP, size_t port, asio::thread_pool& workers);
+asio::awaitable<std::vector<TransferStatus>> asyncStreamOutBoardsToAll(const BoardStream& boards, std::vector<Endpoint> destinations, asio::thread_pool& workers,
+	EncodeOptions options = {}, std::function<void(size_t destination, const TransferStatus&)> onProgress = {});
+
+// Statistics of SUMMARY_BLOCK_BOARDS boards, written at encode time. A game
+// belongs to the block holding its first board.
+struct BlockSummary {
+	uint64_t firstBoard = 0;
+	uint64_t boards = 0;
+	uint64_t codeBitOffset = 0;             // first code of the block in the coded boards, 0 with FLAG_DEDUP
+	uint64_t gameIndex = 0;                 // game holding the block's first board
+	uint32_t games = 0;
+	uint32_t xWins = 0;
+	uint32_t oWins = 0;
+	std::array<uint32_t, 9> gameLengths{};  // [n - 1]: games of n boards, longer games count as 9
+	std::vector<uint16_t> positions;        // distinct board codes of the block, ascending
+
+	bool contains(const Board& board) const;
+};
+
+struct StreamSummary {
+	uint64_t boards = 0;
+	uint64_t games = 0;
+	uint64_t xWins = 0;
+	uint64_t oWins = 0;
+	std::array<uint64_t, 9> gameLengths{};
+};
+
+// Block summaries of a frame, empty if it was encoded without them or their
+// section fails its checksum
+std::vector<BlockSummary> readBlockSummaries(const ByteVector& inData);
+// The queries below return nullopt for an invalid frame or one failing a
+// checksum, so a damaged frame does not pass for one without matches.
+// Answered from the block summaries, decodes only frames without them
+std::optional<StreamSummary> summarizeFrame(const ByteVector& inData);
+// Queries below walk the codes of the blocks they need only, after checking
+// the checksums of every part of the frame they read. Frames without
+// summaries or with FLAG_DEDUP are decoded in full instead.
+// Occurrences of `board`, scanned without building boards
+std::optional<uint64_t> countPosition(const ByteVector& inData, const Board& board);
+// Boards of the blocks `filter` accepts, in stream order
+std::optional<BoardStream> selectBoards(const ByteVector& inData, const std::function<bool(const BlockSummary&)>& filter);
 
 BoardStream extractBoardsFromGames(const GameList& games);
 GameList reconstructGamesFromBoards(const BoardStream& boards);
\ No newline at end of file